@@ -2,6 +2,14 @@ set(sources
   project/src/main.cpp
   project/src/mainWindow.cpp
   project/src/coordFrame.cpp
+  project/src/deviceCommand.cpp
+  project/src/tempAnalytics.cpp
+  project/src/logParser.cpp
+  project/src/portRegistry.cpp
+  project/src/telemetryStream.cpp
+  project/src/fleetTimeline.cpp
+  project/src/proximity.cpp
+  project/include/LeoGeo/portRegistry.hpp
 )
 
 set(includes
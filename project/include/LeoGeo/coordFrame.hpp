@@ -5,6 +5,7 @@
 #include <QLabel>
 #include <QVBoxLayout>
 #include <QWidget>
+#include <vector>
 
 struct Coordinates;
 
@@ -14,7 +15,7 @@ class CoordSet;
 class CoordFrame : public QWidget {
  public:
   explicit CoordFrame(QWidget *parent = nullptr);
-  std::string GetCoords();
+  std::vector<Coordinates> GetTargets();
 
  private:
   std::unique_ptr<QVBoxLayout> layout_;
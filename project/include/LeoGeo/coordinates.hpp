@@ -0,0 +1,6 @@
+#pragma once
+
+struct Coordinates {
+  double latitude;
+  double longitude;
+};
@@ -0,0 +1,171 @@
+#pragma once
+
+#include <QByteArray>
+#include <QIODevice>
+#include <chrono>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "LeoGeo/coordinates.hpp"
+
+// how the end of the device's answer to a command is recognised
+enum class ResponsePolicy {
+  kDrain,        // keep reading until the device goes quiet (log dumps)
+  kAcknowledge,  // keep reading until the expected reply arrives
+  // the answer never ends, TelemetryStream reads it record by record until it
+  // sends the matching stop command. RunCommand() can't run these
+  kStream,
+  kNone,  // the device doesn't answer, done as soon as the frame is written
+};
+
+// payload type of commands that are just the opcode
+struct NoPayload {};
+
+template <typename Payload = NoPayload>
+struct DeviceCommand {
+  using PayloadType = Payload;
+
+  char opcode;
+  // writes the payload into the device's write buffer, in whatever format the
+  // firmware wants it. only commands with a payload have one
+  bool (*encode_payload)(QIODevice *device, const Payload &payload);
+  std::string_view terminator;  // sent after the payload, if any
+  ResponsePolicy response_policy;
+  std::string_view expected_response;
+  // the device resets whenever the port is opened, so it needs a moment
+  // before it will listen
+  std::chrono::milliseconds settle_time;
+  std::chrono::milliseconds first_byte_timeout;
+  // longest gap allowed between bytes once the answer has started, for kDrain
+  // this is also the silence that means the device is done
+  std::chrono::milliseconds idle_timeout;
+  // deadline for the whole answer, RunCommand() gives up on any command that
+  // isn't done by then (a drain still going counts as a failure). for kNone
+  // it's how long to wait for the frame to actually go out
+  std::chrono::milliseconds total_timeout;
+};
+
+// the payload a table entry takes, e.g. PayloadOf<device_commands::kUnlock>
+template <const auto &Command>
+using PayloadOf = typename std::remove_cvref_t<decltype(Command)>::PayloadType;
+
+// the coordinate list the device expects after '@',
+// lat,long,lat,long,... with no spaces and '.' as the decimal point
+bool EncodeCoordinates(QIODevice *device,
+                       const std::vector<Coordinates> &coordinates);
+
+// every command the device's firmware understands. adding a new one is just a
+// new entry here, then MainWindow::RunCommand<device_commands::kWhatever>()
+namespace device_commands {
+using std::chrono_literals::operator""ms;
+using std::chrono_literals::operator""s;
+
+// '!' tells the device to answer with its data log
+inline constexpr DeviceCommand<> kFetchLogs{
+    .opcode = '!',
+    .encode_payload = nullptr,
+    .terminator = "",
+    .response_policy = ResponsePolicy::kDrain,
+    .expected_response = "",
+    .settle_time = 500ms,
+    .first_byte_timeout = 2000ms,
+    .idle_timeout = 1500ms,
+    // the dump ends when the device goes quiet, this is only there so a device
+    // stuck sending garbage can't hang the app. at 9600 baud it's well over a
+    // megabyte of log, hitting it is reported as an error
+    .total_timeout = 1800s,
+};
+
+// '@' tells the device to get ready to receive new coordinates, which follow
+// straight after as a comma separated list
+inline constexpr DeviceCommand<std::vector<Coordinates>> kUploadCoords{
+    .opcode = '@',
+    .encode_payload = &EncodeCoordinates,
+    .terminator = "\n\r",
+    .response_policy = ResponsePolicy::kAcknowledge,
+    .expected_response = "Da",
+    .settle_time = 500ms,
+    .first_byte_timeout = 60s,
+    .idle_timeout = 60s,
+    .total_timeout = 60s,
+};
+
+// '%' tells the device to unlock the box
+inline constexpr DeviceCommand<> kUnlock{
+    .opcode = '%',
+    .encode_payload = nullptr,
+    .terminator = "",
+    .response_policy = ResponsePolicy::kAcknowledge,
+    .expected_response = "Da",
+    .settle_time = 500ms,
+    .first_byte_timeout = 60s,
+    .idle_timeout = 60s,
+    .total_timeout = 60s,
+};
+
+// '$' starts the device streaming its live readings, one log record at a time
+// in the same format as the data log, until it's sent '#'. if the readings
+// stop for longer than idle_timeout the device is assumed gone
+inline constexpr DeviceCommand<> kStreamStart{
+    .opcode = '$',
+    .encode_payload = nullptr,
+    .terminator = "",
+    .response_policy = ResponsePolicy::kStream,
+    .expected_response = "",
+    .settle_time = 500ms,
+    .first_byte_timeout = 2000ms,
+    .idle_timeout = 2000ms,
+    .total_timeout = std::chrono::milliseconds::max(),  // until stopped
+};
+
+// sent on the port the stream is already using, so there's nothing to wait
+// for beyond the byte going out
+inline constexpr DeviceCommand<> kStreamStop{
+    .opcode = '#',
+    .encode_payload = nullptr,
+    .terminator = "",
+    .response_policy = ResponsePolicy::kNone,
+    .expected_response = "",
+    .settle_time = 0ms,
+    .first_byte_timeout = 0ms,
+    .idle_timeout = 0ms,
+    .total_timeout = 50ms,
+};
+}  // namespace device_commands
+
+// writes the command's frame (opcode, payload, terminator) straight into the
+// device's write buffer, without building it up in a temporary first
+template <const auto &Command>
+bool WriteCommand(QIODevice *device, const PayloadOf<Command> &payload = {}) {
+  static_assert(Command.response_policy != ResponsePolicy::kAcknowledge ||
+                    !Command.expected_response.empty(),
+                "acknowledged commands need an expected response");
+  static_assert(std::is_same_v<PayloadOf<Command>, NoPayload> ||
+                    Command.encode_payload != nullptr,
+                "commands with a payload need an encoder");
+
+  if (device->write(&Command.opcode, 1) != 1) return false;
+  if constexpr (Command.encode_payload != nullptr) {
+    if (!Command.encode_payload(device, payload)) return false;
+  }
+  if constexpr (!Command.terminator.empty()) {
+    const auto size = static_cast<qint64>(Command.terminator.size());
+    if (device->write(Command.terminator.data(), size) != size) return false;
+  }
+  return true;
+}
+
+// true once response holds everything the command is waiting for. drained
+// commands never complete early, they finish when the device goes quiet, and
+// commands without an answer are complete straight away
+template <const auto &Command>
+bool ResponseComplete(const QByteArray &response) {
+  if constexpr (Command.response_policy == ResponsePolicy::kAcknowledge) {
+    return response.endsWith(QByteArrayView(Command.expected_response.data(),
+                                            static_cast<qsizetype>(
+                                                Command.expected_response.size())));
+  } else {
+    return Command.response_policy == ResponsePolicy::kNone;
+  }
+}
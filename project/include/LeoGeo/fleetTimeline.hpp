@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <queue>
+#include <string>
+#include <vector>
+
+#include "LeoGeo/logParser.hpp"
+
+struct DeviceLog {
+  std::string name;
+  LogColumns columns;  // always sorted by time
+};
+
+class FleetTimeline;
+
+// holds the logs of any number of devices side by side. nothing is ever
+// copied into one big combined log, time range queries binary search each
+// device's own timestamps, and the combined timeline is merged on the fly
+class FleetTimeline {
+ public:
+  // records [begin, end) of one device
+  struct Span {
+    std::size_t device;
+    std::size_t begin;
+    std::size_t end;
+  };
+
+  // one record of one device, in the merged timeline
+  struct Entry {
+    std::size_t device;
+    std::size_t index;
+  };
+
+  // walks the records of several spans in time order, by k-way merging them
+  // with a heap holding the next record of each span, so each step is
+  // O(log devices) and nothing is merged until it's asked for
+  class MergedCursor {
+   public:
+    MergedCursor(const FleetTimeline &timeline, const std::vector<Span> &spans);
+    bool Next(Entry *entry);
+
+   private:
+    struct Head {
+      std::int64_t msecs;
+      std::size_t device;
+      std::size_t index;
+      std::size_t end;
+      bool operator>(const Head &other) const {
+        return msecs != other.msecs ? msecs > other.msecs
+                                    : device > other.device;
+      }
+    };
+
+    const FleetTimeline &timeline_;
+    std::priority_queue<Head, std::vector<Head>, std::greater<>> heads_;
+  };
+
+  std::size_t AddDevice(std::string name, LogColumns columns);
+  void Clear() { devices_.clear(); }
+
+  [[nodiscard]] bool empty() const { return devices_.empty(); }
+  [[nodiscard]] std::size_t DeviceCount() const { return devices_.size(); }
+  [[nodiscard]] const DeviceLog &Device(std::size_t device) const {
+    return devices_[device];
+  }
+  [[nodiscard]] std::size_t RecordCount() const;
+  [[nodiscard]] std::int64_t FirstMsecs() const;
+  [[nodiscard]] std::int64_t LastMsecs() const;
+
+  // every device's records with from <= msecs <= to, devices without any are
+  // left out
+  [[nodiscard]] std::vector<Span> Query(std::int64_t from,
+                                        std::int64_t to) const;
+  [[nodiscard]] MergedCursor Merge(std::int64_t from, std::int64_t to) const;
+
+ private:
+  std::vector<DeviceLog> devices_;
+};
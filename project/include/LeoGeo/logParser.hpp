@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+// log records stored column by column, so each parsing thread can fill its own
+// buffer and the buffers can be spliced together with plain bulk copies. the
+// main window keeps its log like this too, timestamps stay as msecs since epoch
+// and only become QDateTimes where something is actually displayed
+struct LogColumns {
+  std::vector<std::int64_t> msecs;
+  std::vector<double> latitude;
+  std::vector<double> longitude;
+  std::vector<double> temperature;
+  std::size_t rejected = 0;  // malformed records that were skipped
+
+  [[nodiscard]] std::size_t size() const { return msecs.size(); }
+  [[nodiscard]] bool empty() const { return msecs.empty(); }
+  void reserve(std::size_t count);
+  void clear();
+  // splices other's records from index first onwards onto the end, rejected
+  // counts are added up
+  void Append(const LogColumns &other, std::size_t first = 0);
+};
+
+// parses a single ddMMyy,hhmmss,latitude,longitude,temperature record,
+// appending it to columns. returns false (leaving columns untouched) if the
+// record is malformed
+bool ParseLogRecord(std::string_view record, LogColumns *columns);
+
+// parses a whole log dump, records separated by ';' (or newlines, so saved csv
+// files can be read back in too, header and all). big dumps are split at record
+// boundaries and parsed in parallel, thread_count of 0 means one thread per
+// core
+LogColumns ParseLog(std::string_view data, unsigned thread_count = 0);
@@ -14,27 +14,29 @@
 #include <QMainWindow>
 #include <QMessageBox>
 #include <QPushButton>
+#include <QList>
+#include <QPointF>
 #include <QSerialPort>
+#include <QTimer>
 #include <QVBoxLayout>
 #include <QValueAxis>
 #include <QWebEngineView>
 #include <QtCharts/QChartView>
 #include <QtCharts/QLineSeries>
+#include <QtCharts/QScatterSeries>
 #include <memory>
+#include <string_view>
 #include <vector>
 
 #include "LeoGeo/coordFrame.hpp"
-
-struct Coordinates {
-  double latitude;
-  double longitude;
-};
-
-struct LogData {
-  Coordinates coordinates;
-  double temperature;
-  QDateTime datetime;
-};
+#include "LeoGeo/coordinates.hpp"
+#include "LeoGeo/deviceCommand.hpp"
+#include "LeoGeo/fleetTimeline.hpp"
+#include "LeoGeo/logParser.hpp"
+#include "LeoGeo/portRegistry.hpp"
+#include "LeoGeo/proximity.hpp"
+#include "LeoGeo/telemetryStream.hpp"
+#include "LeoGeo/tempAnalytics.hpp"
 
 class MainWindow;
 
@@ -51,17 +53,39 @@ class MainWindow : public QWidget {
   void ChangePassButtonHandler();
   void UnlockButtonHandler();
   void DataSwitchButtonHandler();
+  void LiveViewButtonHandler();
+  void LiveFrameHandler();
+  void OpenArchivesButtonHandler();
+  void ImportDumpButtonHandler();
+  void FleetRangeHandler(const QDateTime& min, const QDateTime& max);
+  void TargetReportButtonHandler();
 
  private:
   bool CheckValidPort();
-  void UartConfig(QSerialPort* serial_port);
+  template <const auto& Command>
+  bool RunCommand(const PayloadOf<Command>& payload, QByteArray* response);
+  static void UartConfig(QSerialPort* serial_port);
   void UartErrorHandler(QSerialPort::SerialPortError error);
-  void ParseData(std::string data_string);
+  void PortArrivedHandler(const QString& port_name);
+  void PortRemovedHandler(const QString& port_name);
+  void UpdatePortLabel();
+  void WriteCsv(std::string_view data);
+  void ParseData(std::string_view data);
+  void ClearLog();
   void BuildWebView();
   void BuildChart();
+  void UpdateAnalytics();
+  void StopLiveView();
+  void BuildFleetChart(qint64 from, qint64 to);
+  void BuildFleetWebView();
+  void ClearFleetView();
 
   std::string port_name_;
-  std::vector<LogData> log_vector_;
+  LogColumns log_columns_;
+  TempAnalytics temp_analytics_;
+  std::size_t analysed_records_ = 0;  // how much of the log has been analysed
+  FleetTimeline fleet_;
+  bool updating_fleet_chart_ = false;
   std::string password_;
   keychain::Error keychain_error_;
 
@@ -72,7 +96,17 @@ class MainWindow : public QWidget {
   std::unique_ptr<QPushButton> exit_admin_button_;
   std::unique_ptr<QPushButton> change_pass_button_;
   std::unique_ptr<QPushButton> unlock_button_;
+  std::unique_ptr<QPushButton> target_report_button_;
   std::unique_ptr<QPushButton> switch_data_view_button_;
+  std::unique_ptr<QPushButton> live_view_button_;
+  std::unique_ptr<QPushButton> open_archives_button_;
+  std::unique_ptr<QPushButton> import_dump_button_;
+
+  std::unique_ptr<PortRegistry> port_registry_;
+  std::unique_ptr<TelemetryStream> telemetry_stream_;
+  std::unique_ptr<QTimer> live_timer_;
+  QList<QPointF> live_points_;
+  std::size_t live_dropped_ = 0;  // as last shown in the chart title
 
   std::unique_ptr<QErrorMessage> error_message_;
   std::unique_ptr<QMessageBox> message_;
@@ -81,6 +115,12 @@ class MainWindow : public QWidget {
   std::unique_ptr<QChartView> temp_view_;
   std::unique_ptr<QChart> temp_chart_;
   std::unique_ptr<QLineSeries> temp_series_;
+  std::unique_ptr<QLineSeries> rolling_mean_series_;
+  std::unique_ptr<QLineSeries> rolling_min_series_;
+  std::unique_ptr<QLineSeries> rolling_max_series_;
+  std::unique_ptr<QScatterSeries> excursion_series_;
+  std::unique_ptr<QLineSeries> live_series_;
+  std::vector<std::unique_ptr<QLineSeries>> fleet_series_;
   std::unique_ptr<QDateTimeAxis> axis_x_;
   std::unique_ptr<QValueAxis> axis_y_;
 
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <QFileSystemWatcher>
+#include <QHash>
+#include <QObject>
+#include <QSerialPortInfo>
+#include <QString>
+#include <QStringList>
+#include <QTimer>
+#include <memory>
+
+class PortRegistry;
+
+// keeps track of which serial ports exist, so nothing has to enumerate them
+// every time it wants to know. the ports are enumerated once up front, then
+// again only when something is added to or removed from /dev
+class PortRegistry : public QObject {
+  Q_OBJECT
+
+ public:
+  explicit PortRegistry(QObject *parent = nullptr);
+
+  [[nodiscard]] bool Contains(const QString &port_name) const;
+  [[nodiscard]] QStringList PortNames() const;
+  [[nodiscard]] QSerialPortInfo Info(const QString &port_name) const;
+  // false if /dev couldn't be watched (e.g. on windows), in which case the
+  // registry only knows what the last Refresh() found
+  [[nodiscard]] bool IsWatching() const;
+  void Refresh();
+
+ signals:
+  void PortArrived(const QString &port_name);
+  void PortRemoved(const QString &port_name);
+
+ private:
+  QHash<QString, QSerialPortInfo> ports_;
+  std::unique_ptr<QFileSystemWatcher> watcher_;
+  std::unique_ptr<QTimer> rescan_timer_;
+};
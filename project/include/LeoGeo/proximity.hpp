@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "LeoGeo/logParser.hpp"
+
+struct GeoTarget {
+  double latitude;
+  double longitude;
+  double radius_m;
+};
+
+struct TargetReport {
+  // false if the log was empty, nothing below means anything then
+  bool has_points = false;
+  bool reached = false;
+  std::int64_t first_arrival_msecs = 0;  // only meaningful if reached
+  std::int64_t dwell_msecs = 0;          // total time spent inside the radius
+  double closest_m = 0.0;
+  std::int64_t closest_msecs = 0;
+};
+
+class ProximityEngine;
+
+// works out when and how close a logged route came to any number of targets.
+// the points are projected onto a flat plane around the middle of the route
+// and bucketed into a grid once, so each target only ever looks at the points
+// in the grid cells near it, instead of every point in the log
+class ProximityEngine {
+ public:
+  static constexpr double kDefaultCellMetres = 250.0;
+
+  // log has to be in time order, as the device logs it. an empty log is
+  // fine, every report just comes back without points
+  explicit ProximityEngine(const LogColumns &log,
+                           double cell_metres = kDefaultCellMetres);
+
+  [[nodiscard]] std::vector<TargetReport> Evaluate(
+      const std::vector<GeoTarget> &targets) const;
+
+ private:
+  struct Projected {
+    double x;
+    double y;
+  };
+
+  [[nodiscard]] Projected Project(double latitude, double longitude) const;
+  [[nodiscard]] std::int64_t CellX(double x) const;
+  [[nodiscard]] std::int64_t CellY(double y) const;
+  [[nodiscard]] TargetReport EvaluateOne(const GeoTarget &target,
+                                         std::vector<double> *scratch) const;
+  // squared distance from (x, y) to every point in one grid cell, into scratch
+  void CellDistances(std::size_t cell, double x, double y,
+                     std::vector<double> *scratch) const;
+
+  const LogColumns &log_;
+  double ref_latitude_ = 0.0;
+  double ref_longitude_ = 0.0;
+  double metres_per_degree_lon_ = 0.0;
+
+  double cell_metres_;
+  double min_x_ = 0.0;
+  double min_y_ = 0.0;
+  std::int64_t cells_x_ = 0;
+  std::int64_t cells_y_ = 0;
+  std::size_t max_cell_size_ = 0;
+
+  // the points sorted by grid cell, so every cell's points sit next to each
+  // other in memory. the points of cell c are [cell_start_[c], cell_start_[c+1])
+  std::vector<std::size_t> cell_start_;
+  std::vector<double> xs_;
+  std::vector<double> ys_;
+  std::vector<std::size_t> indices_;  // each point's index in the log
+};
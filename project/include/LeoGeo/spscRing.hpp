@@ -0,0 +1,56 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+// fixed size, lock-free queue for exactly one producer thread and one consumer
+// thread. nothing is allocated after construction, so however fast the
+// producer pushes, memory use stays the same; once it's full, pushes fail
+// until the consumer catches up
+template <typename T, std::size_t Capacity>
+class SpscRing {
+  static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0,
+                "capacity must be a power of two");
+
+ public:
+  // producer side only
+  bool TryPush(const T &value) {
+    const std::size_t head = head_.load(std::memory_order_relaxed);
+    if (head - tail_cache_ == Capacity) {
+      tail_cache_ = tail_.load(std::memory_order_acquire);
+      if (head - tail_cache_ == Capacity) return false;
+    }
+    buffer_[head & (Capacity - 1)] = value;
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  // consumer side only, hands every queued value to consume in order and
+  // returns how many there were
+  template <typename F>
+  std::size_t Drain(F &&consume) {
+    const std::size_t tail = tail_.load(std::memory_order_relaxed);
+    const std::size_t head = head_.load(std::memory_order_acquire);
+    for (std::size_t i = tail; i != head; i++) {
+      consume(buffer_[i & (Capacity - 1)]);
+    }
+    tail_.store(head, std::memory_order_release);
+    return head - tail;
+  }
+
+  [[nodiscard]] bool Empty() const {
+    return head_.load(std::memory_order_acquire) ==
+           tail_.load(std::memory_order_acquire);
+  }
+
+ private:
+  // the two indices only ever count up, and are kept on separate cache lines
+  // so the two threads aren't fighting over the same one
+  static constexpr std::size_t kCacheLine = 64;
+
+  alignas(kCacheLine) std::atomic<std::size_t> head_{0};
+  std::size_t tail_cache_ = 0;  // producer's last look at tail_
+  alignas(kCacheLine) std::atomic<std::size_t> tail_{0};
+  alignas(kCacheLine) std::array<T, Capacity> buffer_{};
+};
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <QSerialPort>
+#include <QString>
+#include <QThread>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+#include "LeoGeo/spscRing.hpp"
+
+struct TelemetrySample {
+  std::int64_t msecs;
+  double latitude;
+  double longitude;
+  double temperature;
+};
+
+class TelemetryStream;
+
+// reads the device's live readings on a background thread and hands them to
+// the ui through a lock-free ring buffer. the reader thread is the only
+// producer, whoever calls Drain() is the only consumer. the reader is a
+// QThread rather than a std::thread, QSerialPort needs the event dispatcher
+// every QThread gets to watch the port
+class TelemetryStream {
+ public:
+  // the ui drains this every frame, so it only has to cover a frame or two of
+  // samples, 4096 leaves plenty of headroom
+  static constexpr std::size_t kCapacity = 4096;
+
+  TelemetryStream() = default;
+  TelemetryStream(const TelemetryStream &) = delete;
+  TelemetryStream &operator=(const TelemetryStream &) = delete;
+  ~TelemetryStream();
+
+  void Start(const QString &port_name, void (*configure)(QSerialPort *));
+  void Stop();
+  // true from Start() until Stop(), even if the reader gave up on an error
+  [[nodiscard]] bool IsRunning() const { return reader_ != nullptr; }
+
+  template <typename F>
+  std::size_t Drain(F &&consume) {
+    return ring_.Drain(std::forward<F>(consume));
+  }
+
+  // NoError while the stream is healthy, otherwise whatever stopped it
+  [[nodiscard]] QSerialPort::SerialPortError Error() const {
+    return error_.load(std::memory_order_acquire);
+  }
+  // samples thrown away because the ring was full
+  [[nodiscard]] std::size_t Dropped() const {
+    return dropped_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  void Run(const QString &port_name, void (*configure)(QSerialPort *));
+
+  SpscRing<TelemetrySample, kCapacity> ring_;
+  std::atomic<QSerialPort::SerialPortError> error_{QSerialPort::NoError};
+  std::atomic<std::size_t> dropped_{0};
+  std::unique_ptr<QThread> reader_;
+};
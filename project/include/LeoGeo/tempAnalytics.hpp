@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+struct TempExcursion {
+  std::int64_t start_msecs;
+  std::int64_t end_msecs;
+  double peak;  // furthest reading past the limit during the excursion
+  std::int64_t peak_msecs;
+  bool above;  // true if the excursion went over the upper limit
+};
+
+class TempAnalytics;
+
+class TempAnalytics {
+ public:
+  static constexpr std::int64_t kDefaultWindowMsecs = 60LL * 60 * 1000;
+  static constexpr double kDefaultLowLimit = 0.0;
+  static constexpr double kDefaultHighLimit = 40.0;
+
+  explicit TempAnalytics(std::int64_t window_msecs = kDefaultWindowMsecs,
+                         double low_limit = kDefaultLowLimit,
+                         double high_limit = kDefaultHighLimit);
+
+  // samples have to come in time order. anything not newer than the last
+  // sample is ignored, and false is returned
+  bool AddSample(std::int64_t msecs, double temperature);
+  void Reset();
+
+  [[nodiscard]] std::size_t Count() const { return count_; }
+  [[nodiscard]] double Min() const { return min_; }
+  [[nodiscard]] double Max() const { return max_; }
+  [[nodiscard]] double Mean() const { return mean_; }
+  [[nodiscard]] double Variance() const;
+  [[nodiscard]] double StdDev() const;
+
+  [[nodiscard]] double RollingMean() const;
+  [[nodiscard]] double RollingMin() const;
+  [[nodiscard]] double RollingMax() const;
+
+  [[nodiscard]] double LowLimit() const { return low_limit_; }
+  [[nodiscard]] double HighLimit() const { return high_limit_; }
+  [[nodiscard]] const std::vector<TempExcursion> &Excursions() const {
+    return excursions_;
+  }
+
+ private:
+  struct Sample {
+    std::int64_t msecs;
+    double temperature;
+  };
+
+  void EvictOld(std::int64_t newest_msecs);
+  void TrackExcursion(std::int64_t msecs, double temperature);
+
+  std::int64_t window_msecs_;
+  double low_limit_;
+  double high_limit_;
+
+  // whole-series aggregates, mean and variance use welford's method so they
+  // stay stable no matter how many samples get pushed through
+  std::size_t count_ = 0;
+  std::int64_t last_msecs_ = 0;
+  double mean_ = 0.0;
+  double m2_ = 0.0;
+  double min_ = 0.0;
+  double max_ = 0.0;
+
+  // rolling window aggregates. window_ holds everything inside the window for
+  // the running sum, the other two are monotonic queues so the front is always
+  // the window's min/max
+  std::deque<Sample> window_;
+  std::deque<Sample> window_min_;
+  std::deque<Sample> window_max_;
+  double window_sum_ = 0.0;
+
+  bool in_excursion_ = false;
+  std::vector<TempExcursion> excursions_;
+};
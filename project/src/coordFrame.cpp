@@ -5,8 +5,9 @@
 #include <QLabel>
 #include <QVBoxLayout>
 #include <QWidget>
+#include <vector>
 
-#include "LeoGeo/mainWindow.hpp"
+#include "LeoGeo/coordinates.hpp"
 
 CoordFrame::CoordFrame(QWidget *parent) {
   layout_ = std::make_unique<QVBoxLayout>();
@@ -25,14 +26,9 @@ CoordFrame::CoordFrame(QWidget *parent) {
   this->setLayout(layout_.get());
 }
 
-std::string CoordFrame::GetCoords() {
-  return std::format("{},{},{},{},{},{}",
-                     coord_set_1_->GetCoordinates().latitude,
-                     coord_set_1_->GetCoordinates().longitude,
-                     coord_set_2_->GetCoordinates().latitude,
-                     coord_set_2_->GetCoordinates().longitude,
-                     coord_set_3_->GetCoordinates().latitude,
-                     coord_set_3_->GetCoordinates().longitude);
+std::vector<Coordinates> CoordFrame::GetTargets() {
+  return {coord_set_1_->GetCoordinates(), coord_set_2_->GetCoordinates(),
+          coord_set_3_->GetCoordinates()};
 }
 
 CoordSet::CoordSet(QWidget *parent) : parent_(parent) {
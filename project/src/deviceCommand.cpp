@@ -0,0 +1,29 @@
+#include "LeoGeo/deviceCommand.hpp"
+
+#include <QIODevice>
+#include <array>
+#include <charconv>
+#include <vector>
+
+#include "LeoGeo/coordinates.hpp"
+
+bool EncodeCoordinates(QIODevice *device,
+                       const std::vector<Coordinates> &coordinates) {
+  // to_chars gives the same shortest round trip digits std::format's {} does,
+  // but never looks at the locale, and needs nothing bigger than this buffer
+  std::array<char, 64> buffer{};  // NOLINT
+  char *const end = buffer.data() + buffer.size();
+  bool first = true;
+  for (const auto &coordinate : coordinates) {
+    for (const double value : {coordinate.latitude, coordinate.longitude}) {
+      char *out = buffer.data();
+      if (!first) *out++ = ',';
+      first = false;
+      const auto result = std::to_chars(out, end, value);
+      if (result.ec != std::errc()) return false;
+      const auto size = static_cast<qint64>(result.ptr - buffer.data());
+      if (device->write(buffer.data(), size) != size) return false;
+    }
+  }
+  return true;
+}
@@ -0,0 +1,112 @@
+#include "LeoGeo/fleetTimeline.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "LeoGeo/logParser.hpp"
+
+namespace {
+template <typename T>
+void Permute(std::vector<T> *column, const std::vector<std::size_t> &order) {
+  std::vector<T> sorted;
+  sorted.reserve(column->size());
+  for (const auto i : order) sorted.push_back((*column)[i]);
+  *column = std::move(sorted);
+}
+}  // namespace
+
+FleetTimeline::MergedCursor::MergedCursor(const FleetTimeline &timeline,
+                                          const std::vector<Span> &spans)
+    : timeline_(timeline) {
+  for (const auto &span : spans) {
+    if (span.begin == span.end) continue;
+    heads_.push(Head{timeline_.Device(span.device).columns.msecs[span.begin],
+                     span.device, span.begin, span.end});
+  }
+}
+
+bool FleetTimeline::MergedCursor::Next(Entry *entry) {
+  if (heads_.empty()) return false;
+  Head head = heads_.top();
+  heads_.pop();
+  *entry = Entry{head.device, head.index};
+
+  if (++head.index < head.end) {
+    head.msecs = timeline_.Device(head.device).columns.msecs[head.index];
+    heads_.push(head);
+  }
+  return true;
+}
+
+std::size_t FleetTimeline::AddDevice(std::string name, LogColumns columns) {
+  // the device logs in order, so this is almost always already sorted, but an
+  // archive stitched together from several fetches might not be
+  auto &msecs = columns.msecs;
+  if (!std::is_sorted(msecs.begin(), msecs.end())) {
+    std::vector<std::size_t> order(msecs.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(),
+                     [&msecs](std::size_t a, std::size_t b) {
+                       return msecs[a] < msecs[b];
+                     });
+    Permute(&columns.msecs, order);
+    Permute(&columns.latitude, order);
+    Permute(&columns.longitude, order);
+    Permute(&columns.temperature, order);
+  }
+
+  devices_.push_back(DeviceLog{std::move(name), std::move(columns)});
+  return devices_.size() - 1;
+}
+
+std::size_t FleetTimeline::RecordCount() const {
+  std::size_t count = 0;
+  for (const auto &device : devices_) count += device.columns.size();
+  return count;
+}
+
+std::int64_t FleetTimeline::FirstMsecs() const {
+  auto first = std::numeric_limits<std::int64_t>::max();
+  for (const auto &device : devices_) {
+    if (!device.columns.empty()) {
+      first = std::min(first, device.columns.msecs.front());
+    }
+  }
+  return first;
+}
+
+std::int64_t FleetTimeline::LastMsecs() const {
+  auto last = std::numeric_limits<std::int64_t>::min();
+  for (const auto &device : devices_) {
+    if (!device.columns.empty()) {
+      last = std::max(last, device.columns.msecs.back());
+    }
+  }
+  return last;
+}
+
+std::vector<FleetTimeline::Span> FleetTimeline::Query(std::int64_t from,
+                                                      std::int64_t to) const {
+  std::vector<Span> spans;
+  for (std::size_t device = 0; device < devices_.size(); device++) {
+    const auto &msecs = devices_[device].columns.msecs;
+    const auto begin = std::lower_bound(msecs.begin(), msecs.end(), from);
+    const auto end = std::upper_bound(begin, msecs.end(), to);
+    if (begin == end) continue;
+    spans.push_back(
+        Span{device, static_cast<std::size_t>(begin - msecs.begin()),
+             static_cast<std::size_t>(end - msecs.begin())});
+  }
+  return spans;
+}
+
+FleetTimeline::MergedCursor FleetTimeline::Merge(std::int64_t from,
+                                                 std::int64_t to) const {
+  return MergedCursor(*this, Query(from, to));
+}
@@ -0,0 +1,280 @@
+#include "LeoGeo/logParser.hpp"
+
+#include <QDate>
+#include <QDateTime>
+#include <QTime>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace {
+// below this a dump isn't worth spinning up threads for, the device's own
+// logs are usually a few tens of kilobytes
+constexpr std::size_t kMinChunkBytes = 256 * 1024;
+constexpr std::int64_t kMsecsPerSecond = 1000;
+constexpr std::int64_t kMsecsPerHour = 60 * 60 * kMsecsPerSecond;
+constexpr int kCentury = 2000;  // the device only sends two digit years
+constexpr int kMaxMantissaDigits = 18;
+constexpr std::string_view kCsvHeaderStart = "date";
+
+constexpr bool IsSeparator(char c) {
+  return c == ';' || c == '\n' || c == '\r';
+}
+
+bool ParseDigits(std::string_view text, int *value) {
+  if (text.empty()) return false;
+  int result = 0;
+  for (const char c : text) {
+    if (c < '0' || c > '9') return false;
+    result = result * 10 + (c - '0');  // NOLINT
+  }
+  *value = result;
+  return true;
+}
+
+bool ParseDouble(std::string_view text, double *value) {
+  // not using std::stod/strtod because those follow the c locale, which qt sets
+  // from the environment, so a user with a comma decimal separator can't read
+  // the device's logs. the device never sends more than a handful of digits,
+  // so an integer mantissa divided by an exact power of ten is plenty
+  static constexpr double kPowersOfTen[] = {
+      1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,
+      1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18};
+
+  bool negative = false;
+  if (!text.empty() && (text.front() == '-' || text.front() == '+')) {
+    negative = text.front() == '-';
+    text.remove_prefix(1);
+  }
+
+  std::uint64_t mantissa = 0;
+  int digits = 0;
+  int fraction_digits = 0;
+  bool seen_point = false;
+  bool seen_digit = false;
+  for (const char c : text) {
+    if (c == '.' && !seen_point) {
+      seen_point = true;
+      continue;
+    }
+    if (c < '0' || c > '9') return false;
+    seen_digit = true;
+    // fraction digits past what fits in the mantissa are too small to matter,
+    // but an integer part that long isn't a coordinate or a temperature
+    if (digits == kMaxMantissaDigits) {
+      if (!seen_point) return false;
+      continue;
+    }
+    mantissa = mantissa * 10 + static_cast<std::uint64_t>(c - '0');  // NOLINT
+    digits++;
+    if (seen_point) fraction_digits++;
+  }
+  if (!seen_digit) return false;
+
+  // NOLINTNEXTLINE
+  double result = static_cast<double>(mantissa) / kPowersOfTen[fraction_digits];
+  *value = negative ? -result : result;
+  return true;
+}
+
+std::int64_t DaysFromCivil(int year, int month, int day) {
+  // days since 1970-01-01 in the proleptic gregorian calendar
+  year -= month <= 2 ? 1 : 0;
+  const int era = year / 400;                                  // NOLINT
+  const int year_of_era = year - era * 400;                    // NOLINT
+  const int shifted_month = month > 2 ? month - 3 : month + 9;  // NOLINT
+  const int day_of_year = (153 * shifted_month + 2) / 5 + day - 1;  // NOLINT
+  const int day_of_era = year_of_era * 365 + year_of_era / 4 -      // NOLINT
+                         year_of_era / 100 + day_of_year;           // NOLINT
+  return static_cast<std::int64_t>(era) * 146097 + day_of_era - 719468;  // NOLINT
+}
+
+// the device logs in local time. asking QDateTime to convert every record
+// goes through the system timezone code, which takes a global lock and would
+// serialise all the parsing threads, so the utc offset is looked up once per
+// hour of log instead and reused for the records in between
+class LocalTimeCache {
+ public:
+  bool ToMSecs(int year, int month, int day, int hour, int minute, int second,
+               std::int64_t *msecs) {
+    const std::int64_t naive_hour = DaysFromCivil(year, month, day) * 24 + hour;
+    if (naive_hour != cached_hour_) {
+      const QDateTime hour_start(QDate(year, month, day), QTime(hour, 0));
+      if (!hour_start.isValid()) return false;
+      cached_offset_ =
+          hour_start.toMSecsSinceEpoch() - naive_hour * kMsecsPerHour;
+      cached_hour_ = naive_hour;
+    }
+    *msecs = naive_hour * kMsecsPerHour + cached_offset_ +
+             (minute * 60 + second) * kMsecsPerSecond;  // NOLINT
+    return true;
+  }
+
+ private:
+  std::int64_t cached_hour_ = -1;
+  std::int64_t cached_offset_ = 0;
+};
+
+bool ParseLogRecord(std::string_view record, LogColumns *columns,
+                    LocalTimeCache *time_cache) {
+  // pulls the five comma separated fields out in place, no copies
+  std::string_view fields[5];
+  for (std::size_t i = 0; i + 1 < std::size(fields); i++) {
+    const auto comma = record.find(',');
+    if (comma == std::string_view::npos) return false;
+    fields[i] = record.substr(0, comma);  // NOLINT
+    record.remove_prefix(comma + 1);
+  }
+  fields[4] = record;
+
+  // date is ddMMyy, time is hhmmss but the device drops the leading zero
+  // before 10 o'clock
+  const auto date = fields[0];
+  const auto time = fields[1];
+  if (date.size() != 6 || (time.size() != 5 && time.size() != 6)) {
+    return false;
+  }
+  const std::size_t hour_digits = time.size() - 4;
+  int day = 0;
+  int month = 0;
+  int year = 0;
+  int hour = 0;
+  int minute = 0;
+  int second = 0;
+  if (!ParseDigits(date.substr(0, 2), &day) ||
+      !ParseDigits(date.substr(2, 2), &month) ||
+      !ParseDigits(date.substr(4, 2), &year) ||
+      !ParseDigits(time.substr(0, hour_digits), &hour) ||
+      !ParseDigits(time.substr(hour_digits, 2), &minute) ||
+      !ParseDigits(time.substr(hour_digits + 2, 2), &second)) {
+    return false;
+  }
+  year += kCentury;
+  if (!QDate::isValid(year, month, day) ||
+      !QTime::isValid(hour, minute, second)) {
+    return false;
+  }
+
+  double latitude = 0.0;
+  double longitude = 0.0;
+  double temperature = 0.0;
+  std::int64_t msecs = 0;
+  if (!ParseDouble(fields[2], &latitude) ||
+      !ParseDouble(fields[3], &longitude) ||
+      !ParseDouble(fields[4], &temperature) ||
+      !time_cache->ToMSecs(year, month, day, hour, minute, second, &msecs)) {
+    return false;
+  }
+
+  columns->msecs.push_back(msecs);
+  columns->latitude.push_back(latitude);
+  columns->longitude.push_back(longitude);
+  columns->temperature.push_back(temperature);
+  return true;
+}
+
+void ParseChunk(std::string_view chunk, LogColumns *columns) {
+  LocalTimeCache time_cache;
+  while (!chunk.empty()) {
+    const auto end = std::find_if(chunk.begin(), chunk.end(), IsSeparator);
+    const auto length = static_cast<std::size_t>(end - chunk.begin());
+    std::string_view record = chunk.substr(0, length);
+    chunk.remove_prefix(std::min(length + 1, chunk.size()));
+
+    while (!record.empty() && record.front() == ' ') record.remove_prefix(1);
+    while (!record.empty() && record.back() == ' ') record.remove_suffix(1);
+    if (record.empty()) continue;
+    if (!ParseLogRecord(record, columns, &time_cache)) columns->rejected++;
+  }
+}
+
+template <typename T>
+void Splice(std::vector<T> *into, const std::vector<T> &from,
+            std::size_t first) {
+  into->insert(into->end(),
+               from.begin() + static_cast<std::ptrdiff_t>(first), from.end());
+}
+}  // namespace
+
+void LogColumns::reserve(std::size_t count) {
+  msecs.reserve(count);
+  latitude.reserve(count);
+  longitude.reserve(count);
+  temperature.reserve(count);
+}
+
+void LogColumns::clear() {
+  msecs.clear();
+  latitude.clear();
+  longitude.clear();
+  temperature.clear();
+  rejected = 0;
+}
+
+void LogColumns::Append(const LogColumns &other, std::size_t first) {
+  first = std::min(first, other.size());
+  Splice(&msecs, other.msecs, first);
+  Splice(&latitude, other.latitude, first);
+  Splice(&longitude, other.longitude, first);
+  Splice(&temperature, other.temperature, first);
+  rejected += other.rejected;
+}
+
+bool ParseLogRecord(std::string_view record, LogColumns *columns) {
+  LocalTimeCache time_cache;
+  return ParseLogRecord(record, columns, &time_cache);
+}
+
+LogColumns ParseLog(std::string_view data, unsigned thread_count) {
+  // csv files saved after a fetch start with a header line
+  if (data.starts_with(kCsvHeaderStart)) {
+    data.remove_prefix(std::min(data.find('\n'), data.size()));
+  }
+
+  if (thread_count == 0) thread_count = std::thread::hardware_concurrency();
+  const std::size_t max_chunks = std::max<std::size_t>(
+      1, std::min<std::size_t>(thread_count, data.size() / kMinChunkBytes));
+
+  LogColumns result;
+  if (max_chunks == 1) {
+    ParseChunk(data, &result);
+    return result;
+  }
+
+  // split the buffer into roughly equal pieces, then push each boundary
+  // forward to just past the next record separator, so no record is ever cut
+  // in half. a record is always owned by whichever chunk it starts in
+  std::vector<std::size_t> bounds{0};
+  for (std::size_t i = 1; i < max_chunks; i++) {
+    std::size_t bound = data.size() * i / max_chunks;
+    bound = std::max(bound, bounds.back());
+    while (bound < data.size() && !IsSeparator(data[bound - 1])) bound++;
+    if (bound < data.size()) bounds.push_back(bound);
+  }
+  bounds.push_back(data.size());
+
+  // every thread only ever touches its own LogColumns, so there's nothing to
+  // lock, and since the chunks are in buffer order, splicing them back
+  // together in chunk order keeps the records in the order they were logged
+  const std::size_t chunk_count = bounds.size() - 1;
+  std::vector<LogColumns> chunks(chunk_count);
+  {
+    std::vector<std::jthread> workers;
+    workers.reserve(chunk_count);
+    for (std::size_t i = 0; i < chunk_count; i++) {
+      workers.emplace_back([&data, &bounds, &chunks, i] {
+        ParseChunk(data.substr(bounds[i], bounds[i + 1] - bounds[i]),
+                   &chunks[i]);
+      });
+    }
+  }
+
+  std::size_t total = 0;
+  for (const auto &chunk : chunks) total += chunk.size();
+  result.reserve(total);
+  for (const auto &chunk : chunks) result.Append(chunk);
+  return result;
+}
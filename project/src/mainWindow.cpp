@@ -5,30 +5,52 @@
 #include <QApplication>
 #include <QBoxLayout>
 #include <QButtonGroup>
+#include <QColor>
 #include <QDateTime>
 #include <QDateTimeAxis>
+#include <QDeadlineTimer>
 #include <QDir>
 #include <QDoubleSpinBox>
 #include <QErrorMessage>
+#include <QFile>
+#include <QFileDialog>
+#include <QFileInfo>
+#include <QGuiApplication>
 #include <QHBoxLayout>
 #include <QInputDialog>
 #include <QLabel>
 #include <QMainWindow>
 #include <QMessageBox>
+#include <QPen>
 #include <QPushButton>
+#include <QScreen>
 #include <QSerialPort>
 #include <QSerialPortInfo>
+#include <QSignalBlocker>
+#include <QTextStream>
+#include <QTimer>
 #include <QVBoxLayout>
 #include <QValueAxis>
+#include <QWebEnginePage>
 #include <QWebEngineView>
 #include <QtCharts/QChartView>
 #include <QtCharts/QLineSeries>
+#include <QtCharts/QScatterSeries>
+#include <algorithm>
 #include <chrono>
+#include <cstdint>
+#include <limits>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <thread>
 #include <vector>
 
+#include "LeoGeo/deviceCommand.hpp"
+#include "LeoGeo/fleetTimeline.hpp"
+#include "LeoGeo/logParser.hpp"
+#include "LeoGeo/proximity.hpp"
+
 namespace {
 // this html is loaded into the webview to display the map, after inserting
 // javascript (defined in MainWindow::BuildWebView()) using std::format, to
@@ -60,6 +82,42 @@ constexpr char html[] =
 const std::string kPackage = "com.LeoGeo.LeoGeo";
 const std::string kService = "LeoGeo";
 const std::string kUser = "Admin";
+
+// live view keeps this many of the most recent samples on the chart, older
+// ones scroll off the left
+constexpr qsizetype kLivePoints = 1000;
+constexpr qreal kDefaultRefreshRate = 60.0;
+// inserted into the map html in live view, in place of the logged markers
+constexpr char kLiveMarkerJs[] =
+    "window.liveMarker = new google.maps.Marker({ map: map });";
+
+// with dozens of devices over a week there are far more records than there
+// are pixels, so the fleet view only ever draws up to this many per device on
+// the chart, and this many in total on the map
+constexpr std::size_t kMaxFleetPoints = 2000;
+constexpr std::size_t kMaxFleetMarkers = 5000;
+// inserted into the map html ahead of the fleet markers, so each marker is a
+// short call rather than a whole constructor
+constexpr char kFleetMarkerJs[] =
+    "function m(lat, lng, c) { new google.maps.Marker({ position: {lat: lat, "
+    "lng: lng}, map: map, icon: { path: google.maps.SymbolPath.CIRCLE, "
+    "scale: 4, fillColor: c, fillOpacity: 1, strokeWeight: 0 } }); }\n";
+
+constexpr double kDefaultTargetRadius = 25.0;
+constexpr double kMaxTargetRadius = 100000.0;
+
+std::string FormatMSecs(qint64 msecs) {
+  return QDateTime::fromMSecsSinceEpoch(msecs)
+      .toString("dd.MM hh:mm:ss")
+      .toStdString();
+}
+
+QColor DeviceColour(std::size_t device, std::size_t device_count) {
+  // spreads the devices evenly around the colour wheel
+  const auto hue = static_cast<int>(360 * device / std::max<std::size_t>(  // NOLINT
+                                                      device_count, 1));
+  return QColor::fromHsv(hue, 200, 220);  // NOLINT
+}
 }  // namespace
 
 MainWindow::MainWindow(QWidget *parent) : QWidget(parent) {
@@ -90,9 +148,15 @@ MainWindow::MainWindow(QWidget *parent) : QWidget(parent) {
   admin_mode_button_ = make_unique<QPushButton>("Admin Mode", this);
   switch_data_view_button_ = make_unique<QPushButton>("Show Route", this);
   switch_data_view_button_->setEnabled(false);
+  live_view_button_ = make_unique<QPushButton>("Live View", this);
+  open_archives_button_ = make_unique<QPushButton>("Open Archives", this);
+  import_dump_button_ = make_unique<QPushButton>("Import Dump", this);
 
   button_top_layout_->addWidget(usb_init_button_.get());
   button_top_layout_->addWidget(log_fetch_button_.get());
+  button_top_layout_->addWidget(live_view_button_.get());
+  button_top_layout_->addWidget(open_archives_button_.get());
+  button_top_layout_->addWidget(import_dump_button_.get());
   button_top_layout_->addWidget(admin_mode_button_.get());
   button_top_layout_->addWidget(switch_data_view_button_.get());
 
@@ -100,17 +164,20 @@ MainWindow::MainWindow(QWidget *parent) : QWidget(parent) {
   upload_coord_button_ = make_unique<QPushButton>("Upload Coords", this);
   change_pass_button_ = make_unique<QPushButton>("Change Password", this);
   unlock_button_ = make_unique<QPushButton>("Unlock Box", this);
+  target_report_button_ = make_unique<QPushButton>("Check Targets", this);
 
   button_bottom_layout_->addWidget(exit_admin_button_.get());
   button_bottom_layout_->addWidget(change_pass_button_.get());
   button_bottom_layout_->addWidget(upload_coord_button_.get());
   button_bottom_layout_->addWidget(unlock_button_.get());
+  button_bottom_layout_->addWidget(target_report_button_.get());
 
   // hiding buttons that are only meant to be visible when in admin mode
   exit_admin_button_->hide();
   change_pass_button_->hide();
   upload_coord_button_->hide();
   unlock_button_->hide();
+  target_report_button_->hide();
 
   // chart chartview contains and displays chart, chart contains and displays
   // lineseries, lineseries contains values
@@ -125,10 +192,53 @@ MainWindow::MainWindow(QWidget *parent) : QWidget(parent) {
   axis_y_->setLabelFormat("%i");
   axis_y_->setTitleText("Temperature");
   temp_view_ = make_unique<QChartView>(temp_chart_.get(), this);
+  // drag to zoom in on a stretch of time, right click to zoom back out
+  temp_view_->setRubberBand(QChartView::HorizontalRubberBand);
   temp_view_->show();
   temp_chart_->addAxis(axis_x_.get(), Qt::AlignBottom);
   temp_chart_->addAxis(axis_y_.get(), Qt::AlignLeft);
 
+  // analytics overlays, the rolling ones only ever get appended to as new
+  // records come in (see MainWindow::UpdateAnalytics()), so unlike
+  // temp_series_ they are never rebuilt
+  rolling_mean_series_ = make_unique<QLineSeries>();
+  rolling_mean_series_->setName("Rolling Mean");
+  rolling_min_series_ = make_unique<QLineSeries>();
+  rolling_min_series_->setName("Rolling Min");
+  rolling_min_series_->setPen(QPen(Qt::blue, 1, Qt::DashLine));
+  rolling_max_series_ = make_unique<QLineSeries>();
+  rolling_max_series_->setName("Rolling Max");
+  rolling_max_series_->setPen(QPen(Qt::darkRed, 1, Qt::DashLine));
+  excursion_series_ = make_unique<QScatterSeries>();
+  excursion_series_->setName(
+      tr(std::format("Out of Range ({:g} to {:g})", temp_analytics_.LowLimit(),
+                     temp_analytics_.HighLimit())
+             .c_str()));
+  excursion_series_->setMarkerSize(8);  // NOLINT
+  excursion_series_->setColor(Qt::red);
+  for (QXYSeries *series :
+       {static_cast<QXYSeries *>(rolling_mean_series_.get()),
+        static_cast<QXYSeries *>(rolling_min_series_.get()),
+        static_cast<QXYSeries *>(rolling_max_series_.get()),
+        static_cast<QXYSeries *>(excursion_series_.get())}) {
+    temp_chart_->addSeries(series);
+    series->attachAxis(axis_x_.get());
+    series->attachAxis(axis_y_.get());
+  }
+
+  // live view gets its own series, so the logged data is still there once it
+  // stops
+  live_series_ = make_unique<QLineSeries>();
+  live_series_->setName("Live");
+  live_series_->hide();
+  temp_chart_->addSeries(live_series_.get());
+  live_series_->attachAxis(axis_x_.get());
+  live_series_->attachAxis(axis_y_.get());
+  live_points_.reserve(kLivePoints + TelemetryStream::kCapacity);
+
+  telemetry_stream_ = make_unique<TelemetryStream>();
+  live_timer_ = make_unique<QTimer>();
+
   // map is a webview which loads some html
   map_view_ = std::make_unique<QWebEngineView>(this);
   map_view_->hide();
@@ -147,6 +257,14 @@ MainWindow::MainWindow(QWidget *parent) : QWidget(parent) {
   layout_->addWidget(map_view_.get());
   layout_->addWidget(coord_frame_.get());
 
+  // keeps track of serial ports coming and going, so we don't have to ask the
+  // os every time we talk to the device
+  port_registry_ = make_unique<PortRegistry>();
+  connect(port_registry_.get(), &PortRegistry::PortArrived, this,
+          &MainWindow::PortArrivedHandler);
+  connect(port_registry_.get(), &PortRegistry::PortRemoved, this,
+          &MainWindow::PortRemovedHandler);
+
   // assosciating clicking buttons with their corresponding functions.
   connect(usb_init_button_.get(), &QPushButton::clicked, this,
           &MainWindow::UsbInitButtonHandler);
@@ -162,8 +280,20 @@ MainWindow::MainWindow(QWidget *parent) : QWidget(parent) {
           &MainWindow::ChangePassButtonHandler);
   connect(unlock_button_.get(), &QPushButton::clicked, this,
           &MainWindow::UnlockButtonHandler);
+  connect(target_report_button_.get(), &QPushButton::clicked, this,
+          &MainWindow::TargetReportButtonHandler);
   connect(switch_data_view_button_.get(), &QPushButton::clicked, this,
           &MainWindow::DataSwitchButtonHandler);
+  connect(live_view_button_.get(), &QPushButton::clicked, this,
+          &MainWindow::LiveViewButtonHandler);
+  connect(live_timer_.get(), &QTimer::timeout, this,
+          &MainWindow::LiveFrameHandler);
+  connect(open_archives_button_.get(), &QPushButton::clicked, this,
+          &MainWindow::OpenArchivesButtonHandler);
+  connect(import_dump_button_.get(), &QPushButton::clicked, this,
+          &MainWindow::ImportDumpButtonHandler);
+  connect(axis_x_.get(), &QDateTimeAxis::rangeChanged, this,
+          &MainWindow::FleetRangeHandler);
 
   this->setLayout(layout_.get());
   this->setWindowTitle(tr("LeoGeo"));
@@ -172,59 +302,33 @@ MainWindow::MainWindow(QWidget *parent) : QWidget(parent) {
 
 void MainWindow::UsbInitButtonHandler() {
   // just gets a list of the available serial ports and lists them back to the
-  // user to select one
-  QStringList items;
-  foreach (auto &port, QSerialPortInfo::availablePorts()) {
-    items << port.portName();
-  }
+  // user to select one. the registry already knows which ports exist, unless
+  // it can't watch for changes, in which case it gets asked to look again
+  if (!port_registry_->IsWatching()) port_registry_->Refresh();
 
-  bool ok = false;
   port_name_ = QInputDialog::getItem(
                    this, tr("Serial Port"),
-                   tr("Choose the serial port you wish to connect with"), items)
+                   tr("Choose the serial port you wish to connect with"),
+                   port_registry_->PortNames())
                    .toStdString();
+  UpdatePortLabel();
 }
 
 void MainWindow::LogFetchButtonHandler() {
-  if (!CheckValidPort()) return;
-
-  QSerialPort serial_port;
-  serial_port.setPortName(tr(port_name_.c_str()));
-
-  UartConfig(&serial_port);
-
-  if (!serial_port.open(QIODevice::ReadWrite)) {
-    UartErrorHandler(serial_port.error());
-    return;
-  }
-  std::this_thread::sleep_for(std::chrono::milliseconds(500));  // NOLINT
-  // sending the device a '!' tells it to answer with its data log
-  if (serial_port.write("!") == -1) {
-    error_message_->showMessage(tr("Device write error"));
-  }
-  if (!serial_port.waitForBytesWritten()) {
-    UartErrorHandler(serial_port.error());
-    return;
-  }
-
   QByteArray data_bytes;
-  serial_port.waitForReadyRead(2000);  // NOLINT
-  data_bytes.append(serial_port.readAll());
-  while (serial_port.waitForReadyRead(500)) {  // NOLINT
-    data_bytes.append(serial_port.readAll());
-    std::this_thread::sleep_for(std::chrono::milliseconds(50));  // NOLINT
-  }
-  std::this_thread::sleep_for(std::chrono::milliseconds(1000));  // NOLINT
-  data_bytes.append(serial_port.readAll());
-  serial_port.close();
+  if (!RunCommand<device_commands::kFetchLogs>({}, &data_bytes)) return;
 
-  std::string data_string = data_bytes.toStdString();
-  if (data_string.empty()) {
+  const std::string_view data(data_bytes.constData(),
+                              static_cast<std::size_t>(data_bytes.size()));
+  if (data.empty()) {
     error_message_->showMessage(tr("Received no data"));
     return;
   }
 
-  ParseData(data_string);
+  ClearFleetView();
+  WriteCsv(data);
+  ParseData(data);
+  UpdateAnalytics();
   BuildChart();
   BuildWebView();
 
@@ -269,6 +373,7 @@ void MainWindow::AdminModeButtonHandler() {
     upload_coord_button_->show();
     change_pass_button_->show();
     unlock_button_->show();
+    target_report_button_->show();
     coord_frame_->show();
   } else {
     error_message_->showMessage(tr("error_window", "Incorrect Password"));
@@ -284,62 +389,14 @@ void MainWindow::ExitAdminButtonHandler() {
   upload_coord_button_->hide();
   change_pass_button_->hide();
   unlock_button_->hide();
+  target_report_button_->hide();
   coord_frame_->hide();
 };
 
 void MainWindow::UploadCoordButtonHandler() {
-  if (!CheckValidPort()) return;
-
-  QSerialPort serial_port;
-  serial_port.setPortName(port_name_.c_str());
-
-  UartConfig(&serial_port);
-
-  if (!serial_port.open(QIODevice::ReadWrite)) {
-    UartErrorHandler(serial_port.error());
-    return;
-  }
-  std::this_thread::sleep_for(std::chrono::milliseconds(500));  // NOLINT
-  // sending the device a '@' tells it get ready to receive new coordinates
-  if (serial_port.write("@") == -1) {
-    error_message_->showMessage(tr("Device write error"));
-  }
-  if (!serial_port.waitForBytesWritten()) {
-    UartErrorHandler(serial_port.error());
-    return;
-  }
-
-  if (serial_port.write(coord_frame_->GetCoords().c_str()) == -1) {
-    error_message_->showMessage(tr("Device write error"));
-  }
-  if (!serial_port.waitForBytesWritten()) {
-    UartErrorHandler(serial_port.error());
-    return;
-  }
-
-  if (serial_port.write("\n\r") == -1) {
-    error_message_->showMessage(tr("Device write error"));
-  }
-  if (!serial_port.waitForBytesWritten()) {
-    UartErrorHandler(serial_port.error());
-    return;
-  }
-
-  QByteArray data_bytes;
-  int loop_num = 0;
-  // waits for the device to respond, or timeout (loop_num exceeds 50)
-  while (data_bytes.toStdString() != "Da") {
-    if (loop_num >= 50) {  // NOLINT
-      break;
-    }
-    serial_port.waitForReadyRead(1000);          // NOLINT
-    while (serial_port.waitForReadyRead(100)) {  // NOLINT
-      data_bytes.append(serial_port.readAll());
-    }
-    std::this_thread::sleep_for(std::chrono::milliseconds(100));  // NOLINT
-    loop_num++;
-  }
-  serial_port.close();
+  QByteArray response;
+  RunCommand<device_commands::kUploadCoords>(coord_frame_->GetTargets(),
+                                             &response);
 };
 
 void MainWindow::ChangePassButtonHandler() {
@@ -386,54 +443,389 @@ void MainWindow::ChangePassButtonHandler() {
 };
 
 void MainWindow::UnlockButtonHandler() {
+  QByteArray response;
+  RunCommand<device_commands::kUnlock>({}, &response);
+}
+
+void MainWindow::DataSwitchButtonHandler() {
+  // toggles between showing the map and the chart
+  if (map_view_->isVisible()) {
+    map_view_->hide();
+    temp_view_->show();
+    switch_data_view_button_->setText("Show Route");
+  } else {
+    map_view_->show();
+    temp_view_->hide();
+    switch_data_view_button_->setText("Show Temperature");
+  }
+}
+
+void MainWindow::LiveViewButtonHandler() {
+  if (telemetry_stream_->IsRunning()) {
+    StopLiveView();
+    return;
+  }
   if (!CheckValidPort()) return;
 
-  QSerialPort serial_port;
-  serial_port.setPortName(port_name_.c_str());
+  // the device pushes samples as fast as it likes on the stream's own thread,
+  // the chart and map only get redrawn once per screen refresh with whatever
+  // has arrived since the last one
+  telemetry_stream_->Start(QString::fromStdString(port_name_),
+                           &MainWindow::UartConfig);
+  ClearFleetView();
+
+  live_points_.clear();
+  live_dropped_ = 0;
+  live_series_->clear();
+  live_series_->show();
+  temp_chart_->setTitle(tr("Live"));
+  temp_series_->hide();
+  rolling_mean_series_->hide();
+  rolling_min_series_->hide();
+  rolling_max_series_->hide();
+  excursion_series_->hide();
+  map_view_->setHtml(std::format(html, kLiveMarkerJs).c_str());
+
+  qreal refresh_rate = QGuiApplication::primaryScreen()->refreshRate();
+  if (refresh_rate <= 0) refresh_rate = kDefaultRefreshRate;
+  live_timer_->start(static_cast<int>(1000.0 / refresh_rate));  // NOLINT
+
+  log_fetch_button_->setEnabled(false);
+  switch_data_view_button_->setEnabled(true);
+  live_view_button_->setText("Stop Live View");
+}
 
-  UartConfig(&serial_port);
+void MainWindow::LiveFrameHandler() {
+  const auto error = telemetry_stream_->Error();
+  if (error != QSerialPort::NoError) {
+    StopLiveView();
+    UartErrorHandler(error);
+    return;
+  }
 
-  if (!serial_port.open(QIODevice::ReadWrite)) {
-    UartErrorHandler(serial_port.error());
+  // if the ui ever falls far enough behind for the ring to fill up, the user
+  // should know the chart has gaps in it
+  const std::size_t dropped = telemetry_stream_->Dropped();
+  if (dropped != live_dropped_) {
+    live_dropped_ = dropped;
+    temp_chart_->setTitle(
+        tr(std::format("Live ({} samples dropped)", dropped).c_str()));
+  }
+
+  bool got_samples = false;
+  TelemetrySample latest{};
+  telemetry_stream_->Drain([&](const TelemetrySample &sample) {
+    live_points_.append(QPointF(static_cast<qreal>(sample.msecs),
+                                sample.temperature));
+    latest = sample;
+    got_samples = true;
+  });
+  if (!got_samples) return;
+
+  // only the newest kLivePoints are kept, so the chart costs the same to draw
+  // no matter how long live view has been running
+  if (live_points_.size() > kLivePoints) {
+    live_points_.remove(0, live_points_.size() - kLivePoints);
+  }
+  live_series_->replace(live_points_);
+
+  const auto [lowest, highest] = std::minmax_element(
+      live_points_.cbegin(), live_points_.cend(),
+      [](const QPointF &a, const QPointF &b) { return a.y() < b.y(); });
+  axis_x_->setRange(QDateTime::fromMSecsSinceEpoch(
+                        static_cast<qint64>(live_points_.front().x())),
+                    QDateTime::fromMSecsSinceEpoch(
+                        static_cast<qint64>(live_points_.back().x())));
+  axis_y_->setRange(lowest->y() - 1, highest->y() + 1);
+
+  // moves the one live marker, rather than reloading the whole map
+  map_view_->page()->runJavaScript(QString::fromStdString(std::format(
+      "if (window.liveMarker) {{ liveMarker.setPosition({{lat: {}, lng: {}}}); "
+      "map.panTo(liveMarker.getPosition()); }}",
+      latest.latitude, latest.longitude)));
+}
+
+void MainWindow::StopLiveView() {
+  live_timer_->stop();
+  telemetry_stream_->Stop();
+
+  live_series_->hide();
+  temp_series_->show();
+  rolling_mean_series_->show();
+  rolling_min_series_->show();
+  rolling_max_series_->show();
+  excursion_series_->show();
+  // puts the logged data (and its title) back on the chart and map
+  BuildChart();
+  UpdateAnalytics();
+  BuildWebView();
+
+  log_fetch_button_->setEnabled(true);
+  switch_data_view_button_->setEnabled(!log_columns_.empty());
+  live_view_button_->setText("Live View");
+}
+
+void MainWindow::OpenArchivesButtonHandler() {
+  // loads any number of saved device logs (the csv files written after each
+  // fetch, or raw dumps) and shows them all together, one colour per device
+  const QStringList file_names = QFileDialog::getOpenFileNames(
+      this, tr("Open Device Logs"), QDir::homePath(),
+      tr("Device logs (*.csv *.txt);;All files (*)"));
+  if (file_names.isEmpty()) return;
+  if (telemetry_stream_->IsRunning()) StopLiveView();
+
+  ClearFleetView();
+  foreach (auto &file_name, file_names) {
+    QFile file(file_name);
+    if (!file.open(QIODevice::ReadOnly)) {
+      error_message_->showMessage(
+          tr(std::format("Error: could not open {}", file_name.toStdString())
+                 .c_str()));
+      continue;
+    }
+    const QByteArray bytes = file.readAll();
+    LogColumns columns = ParseLog(std::string_view(
+        bytes.constData(), static_cast<std::size_t>(bytes.size())));
+    // a file with no usable records would just be an empty line on the chart
+    // and a meaningless entry in the target report
+    if (columns.empty()) {
+      error_message_->showMessage(
+          tr(std::format("Error: no log records in {}", file_name.toStdString())
+                 .c_str()));
+      continue;
+    }
+    fleet_.AddDevice(QFileInfo(file_name).completeBaseName().toStdString(),
+                     std::move(columns));
+  }
+  if (fleet_.RecordCount() == 0) {
+    error_message_->showMessage(tr("Received no data"));
+    fleet_.Clear();
     return;
   }
-  std::this_thread::sleep_for(std::chrono::milliseconds(500));  // NOLINT
-  // sending the device a '%' tells it to unlock the box
-  if (serial_port.write("%") == -1) {
-    error_message_->showMessage(tr("Device write error"));
+
+  temp_series_->hide();
+  rolling_mean_series_->hide();
+  rolling_min_series_->hide();
+  rolling_max_series_->hide();
+  excursion_series_->hide();
+  temp_chart_->legend()->show();
+  BuildFleetChart(fleet_.FirstMsecs(), fleet_.LastMsecs());
+  BuildFleetWebView();
+  switch_data_view_button_->setEnabled(true);
+}
+
+void MainWindow::ImportDumpButtonHandler() {
+  // reads an archived raw dump (or a saved csv) back in as if it had just been
+  // fetched from the device. these can be tens of megabytes, which is where
+  // ParseLog() splitting the work across every core pays off
+  const QString file_name = QFileDialog::getOpenFileName(
+      this, tr("Import Log Dump"), QDir::homePath(),
+      tr("Device logs (*.csv *.txt);;All files (*)"));
+  if (file_name.isEmpty()) return;
+
+  QFile file(file_name);
+  if (!file.open(QIODevice::ReadOnly)) {
+    error_message_->showMessage(tr(
+        std::format("Error: could not open {}", file_name.toStdString())
+            .c_str()));
+    return;
   }
-  if (!serial_port.waitForBytesWritten()) {
-    UartErrorHandler(serial_port.error());
+  const QByteArray bytes = file.readAll();
+  if (bytes.isEmpty()) {
+    error_message_->showMessage(tr("Received no data"));
     return;
   }
-  QByteArray data_bytes;
-  int loop_num = 0;
-  // waits for the device to respond, or timeout (loop_num exceeds 50)
-  while (data_bytes.toStdString() != "Da") {
-    if (loop_num >= 50) {  // NOLINT
-      break;
-    }
-    serial_port.waitForReadyRead(1000);          // NOLINT
-    while (serial_port.waitForReadyRead(100)) {  // NOLINT
-      data_bytes.append(serial_port.readAll());
+  if (telemetry_stream_->IsRunning()) StopLiveView();
+
+  // an import replaces whatever was loaded, a different log tacked onto the end
+  // would jump back in time
+  ClearFleetView();
+  ClearLog();
+  ParseData(std::string_view(bytes.constData(),
+                             static_cast<std::size_t>(bytes.size())));
+  UpdateAnalytics();
+  BuildChart();
+  BuildWebView();
+
+  switch_data_view_button_->setEnabled(!log_columns_.empty());
+}
+
+void MainWindow::FleetRangeHandler(const QDateTime &min, const QDateTime &max) {
+  // zooming or scrolling the chart only redraws what's now on screen, found by
+  // binary searching each device's timestamps
+  if (fleet_.empty() || updating_fleet_chart_) return;
+  BuildFleetChart(min.toMSecsSinceEpoch(), max.toMSecsSinceEpoch());
+}
+
+void MainWindow::BuildFleetChart(qint64 from, qint64 to) {
+  // replacing a series' points resizes the axes, which would come straight
+  // back here through FleetRangeHandler()
+  updating_fleet_chart_ = true;
+
+  while (fleet_series_.size() < fleet_.DeviceCount()) {
+    const std::size_t device = fleet_series_.size();
+    auto series = std::make_unique<QLineSeries>();
+    series->setName(tr(fleet_.Device(device).name.c_str()));
+    series->setColor(DeviceColour(device, fleet_.DeviceCount()));
+    temp_chart_->addSeries(series.get());
+    series->attachAxis(axis_x_.get());
+    series->attachAxis(axis_y_.get());
+    fleet_series_.push_back(std::move(series));
+  }
+
+  std::vector<QList<QPointF>> points(fleet_.DeviceCount());
+  double lowest = std::numeric_limits<double>::max();
+  double highest = std::numeric_limits<double>::lowest();
+  for (const auto &span : fleet_.Query(from, to)) {
+    // big ranges get thinned out evenly, no point drawing more points than
+    // the chart is wide
+    const auto &columns = fleet_.Device(span.device).columns;
+    const std::size_t stride =
+        std::max<std::size_t>(1, (span.end - span.begin) / kMaxFleetPoints);
+    auto &device_points = points[span.device];
+    device_points.reserve(
+        static_cast<qsizetype>((span.end - span.begin) / stride + 1));
+    for (std::size_t i = span.begin; i < span.end; i += stride) {
+      device_points.append(QPointF(static_cast<qreal>(columns.msecs[i]),
+                                   columns.temperature[i]));
+      lowest = std::min(lowest, columns.temperature[i]);
+      highest = std::max(highest, columns.temperature[i]);
     }
-    std::this_thread::sleep_for(std::chrono::milliseconds(100));  // NOLINT
-    loop_num++;
   }
-  serial_port.close();
+  for (std::size_t device = 0; device < fleet_series_.size(); device++) {
+    fleet_series_[device]->replace(points[device]);
+  }
+
+  axis_x_->setRange(QDateTime::fromMSecsSinceEpoch(from),
+                    QDateTime::fromMSecsSinceEpoch(to));
+  if (lowest <= highest) axis_y_->setRange(lowest - 1, highest + 1);
+  temp_view_->update();
+
+  updating_fleet_chart_ = false;
 }
 
-void MainWindow::DataSwitchButtonHandler() {
-  // toggles between showing the map and the chart
-  if (map_view_->isVisible()) {
-    map_view_->hide();
-    temp_view_->show();
-    switch_data_view_button_->setText("Show Route");
+void MainWindow::BuildFleetWebView() {
+  // markers are added in time order across all devices, walking the merged
+  // timeline, so where the routes cross the later visit ends up on top
+  const std::size_t stride =
+      std::max<std::size_t>(1, fleet_.RecordCount() / kMaxFleetMarkers);
+
+  std::vector<std::string> colours;
+  for (std::size_t device = 0; device < fleet_.DeviceCount(); device++) {
+    colours.push_back(DeviceColour(device, fleet_.DeviceCount())
+                          .name()
+                          .toStdString());
+  }
+
+  std::string markers_js = kFleetMarkerJs;
+  auto cursor = fleet_.Merge(fleet_.FirstMsecs(), fleet_.LastMsecs());
+  FleetTimeline::Entry entry{};
+  for (std::size_t i = 0; cursor.Next(&entry); i++) {
+    if (i % stride != 0) continue;
+    const auto &columns = fleet_.Device(entry.device).columns;
+    markers_js += std::format("m({}, {}, '{}');\n",
+                              columns.latitude[entry.index],
+                              columns.longitude[entry.index],
+                              colours[entry.device]);
+  }
+
+  auto request_html = std::format(html, markers_js);
+  map_view_->setHtml(request_html.c_str());
+}
+
+void MainWindow::ClearFleetView() {
+  // back to showing the one device's log
+  if (fleet_.empty()) return;
+  fleet_.Clear();
+  for (auto &series : fleet_series_) temp_chart_->removeSeries(series.get());
+  fleet_series_.clear();
+
+  temp_series_->show();
+  rolling_mean_series_->show();
+  rolling_min_series_->show();
+  rolling_max_series_->show();
+  excursion_series_->show();
+  temp_chart_->legend()->hide();
+  BuildChart();
+  BuildWebView();
+  switch_data_view_button_->setEnabled(!log_columns_.empty());
+}
+
+void MainWindow::TargetReportButtonHandler() {
+  // checks the logged routes against the targets entered in the coord frame,
+  // either the fetched log or every device in the fleet view, and reports when
+  // and how close each one got to each target
+  if (log_columns_.empty() && fleet_.empty()) {
+    error_message_->showMessage(
+        tr("Error: no log data loaded. Please fetch logs or open archives "
+           "first"));
+    return;
+  }
+
+  // targets still at the coord frame's default of 0,0 haven't been filled in,
+  // so they're left out rather than reported thousands of kilometres away.
+  // the rest keep their number from the coord frame
+  const auto coordinates = coord_frame_->GetTargets();
+  std::vector<std::size_t> target_numbers;
+  for (std::size_t i = 0; i < coordinates.size(); i++) {
+    if (coordinates[i].latitude != 0.0 || coordinates[i].longitude != 0.0) {
+      target_numbers.push_back(i + 1);
+    }
+  }
+  if (target_numbers.empty()) {
+    error_message_->showMessage(
+        tr("Error: no targets set. Please enter target coordinates first"));
+    return;
+  }
+
+  bool ok = false;
+  const double radius = QInputDialog::getDouble(
+      this, tr("Targets"), tr("Target radius (metres)"), kDefaultTargetRadius,
+      1, kMaxTargetRadius, 0, &ok);
+  if (!ok) return;
+
+  std::vector<GeoTarget> targets;
+  for (const auto number : target_numbers) {
+    const auto &target = coordinates[number - 1];
+    targets.push_back(GeoTarget{target.latitude, target.longitude, radius});
+  }
+
+  std::string report;
+  const auto report_device = [&](const std::string &name,
+                                 const LogColumns &columns) {
+    const auto results = ProximityEngine(columns).Evaluate(targets);
+    report += std::format("{}:\n", name);
+    for (std::size_t i = 0; i < results.size(); i++) {
+      const auto &result = results[i];
+      report += std::format("  Target {}: ", target_numbers[i]);
+      if (!result.has_points) {
+        report += "no data\n";
+        continue;
+      }
+      if (result.reached) {
+        const auto dwell_secs = result.dwell_msecs / 1000;  // NOLINT
+        report += std::format("reached {}, stayed {}m {}s, ",
+                              FormatMSecs(result.first_arrival_msecs),
+                              dwell_secs / 60, dwell_secs % 60);  // NOLINT
+      } else {
+        report += "not reached, ";
+      }
+      report += std::format("closest {:.1f} m at {}\n", result.closest_m,
+                            FormatMSecs(result.closest_msecs));
+    }
+  };
+
+  if (!fleet_.empty()) {
+    for (std::size_t device = 0; device < fleet_.DeviceCount(); device++) {
+      report_device(fleet_.Device(device).name, fleet_.Device(device).columns);
+    }
   } else {
-    map_view_->show();
-    temp_view_->hide();
-    switch_data_view_button_->setText("Show Temperature");
+    report_device(port_name_.empty() ? "Fetched log" : port_name_,
+                  log_columns_);
   }
+
+  message_->setText(tr(report.c_str()));
+  message_->exec();
 }
 
 void MainWindow::UartErrorHandler(QSerialPort::SerialPortError error) {
@@ -484,10 +876,51 @@ void MainWindow::UartErrorHandler(QSerialPort::SerialPortError error) {
   // i hate qt
 }
 
-void MainWindow::ParseData(std::string data_string) {
-  // takes the string from the device's logs and splits it up, making useful
-  // data, and writing to a csv file
+void MainWindow::PortArrivedHandler(const QString &port_name) {
+  // if nothing usable is selected and a usb serial device gets plugged in, it's
+  // almost certainly the box, so connect to it straight away
+  if (port_registry_->Contains(QString::fromStdString(port_name_))) {
+    UpdatePortLabel();  // might be the selected port coming back
+    return;
+  }
+  if (!port_registry_->Info(port_name).hasVendorIdentifier()) return;
+  port_name_ = port_name.toStdString();
+  UpdatePortLabel();
+
+  // not modal, plugging the box in shouldn't block whatever the user is doing
+  message_->setText(
+      tr(std::format("Device plugged in on {}, now using that port",
+                     port_name_)
+             .c_str()));
+  message_->show();
+}
+
+void MainWindow::PortRemovedHandler(const QString &port_name) {
+  // the port name is kept, so if the same device gets plugged back in it's
+  // picked straight back up
+  if (port_name.toStdString() != port_name_) return;
+  UpdatePortLabel();
+  error_message_->showMessage(
+      tr(std::format("Device on {} was disconnected", port_name_).c_str()));
+}
 
+void MainWindow::UpdatePortLabel() {
+  // the connect button shows which port is in use, so a port picked
+  // automatically by PortArrivedHandler() doesn't go unnoticed
+  if (port_name_.empty()) {
+    usb_init_button_->setText(tr("Connect"));
+    usb_init_button_->setToolTip({});
+    return;
+  }
+  const bool present =
+      port_registry_->Contains(QString::fromStdString(port_name_));
+  usb_init_button_->setText(tr(
+      std::format("Port: {}{}", port_name_, present ? "" : " (unplugged)")
+          .c_str()));
+  usb_init_button_->setToolTip(tr("Click to choose a different serial port"));
+}
+
+void MainWindow::WriteCsv(std::string_view data) {
   // the data is received in this format:
   // ddMMyy,hhmmss,latitude(float),longitude(float),temperature(float);ddMMyy,hhmm...
   QFile file(QDir::homePath() + "/LeoGeoData.csv");
@@ -497,56 +930,70 @@ void MainWindow::ParseData(std::string data_string) {
     return;
   }
   QTextStream stream(&file);
-  stream << "date, time, latitude, longitude, temperature" << Qt::endl;
-  while (!data_string.empty()) {
-    // the values in the string are already comma separated, with a semicolon
-    // separating each line, so we can just write the string up to the first
-    // semicolon directly to the csv file
-    stream << data_string.substr(0, data_string.find_first_of(";")).c_str()
-           << Qt::endl;
-
-    // for the rest, we pull out the piece of the string that we need, and then
-    // delete the piece we just pulled out. that we all we have to do is
-    // repeatedly pull out the first bit of data, up to the first comma (or
-    // semicolon)
-    std::string date = data_string.substr(0, data_string.find_first_of(","));
-    data_string.erase(0, data_string.find_first_of(",") + 1);
-    std::string time = data_string.substr(0, data_string.find_first_of(","));
-    if (time.length() == 5) time = "0" + time;  // NOLINT
-    data_string.erase(0, data_string.find_first_of(",") + 1);
-    QDateTime datetime =
-        QDateTime::fromString((date + time).c_str(), "ddMMyyhhmmss")
-            .addYears(100);  // NOLINT
-
-    double latitude =
-        std::stod(data_string.substr(0, data_string.find_first_of(",")));
-    data_string.erase(0, data_string.find_first_of(",") + 1);
-
-    double longitude =
-        std::stod(data_string.substr(0, data_string.find_first_of(",")));
-    data_string.erase(0, data_string.find_first_of(",") + 1);
-
-    double temperature =
-        std::stod(data_string.substr(0, data_string.find_first_of(";")));
-    data_string.erase(0, data_string.find_first_of(";") + 1);
-
-    // finally, take the data we just pulled, build a LogData object from it,
-    // and add it to the vector of log data
-    log_vector_.push_back(
-        LogData{Coordinates{latitude, longitude}, temperature, datetime});
+  stream << "date, time, latitude, longitude, temperature\n";
+  // the values in the string are already comma separated, with a semicolon
+  // separating each line, so each record can be written straight to the csv
+  // file. the stream buffers it all and writes it out in one go at the end
+  while (!data.empty()) {
+    const auto record = data.substr(0, data.find(';'));
+    data.remove_prefix(std::min(record.size() + 1, data.size()));
+    if (record.empty()) continue;
+    stream << QByteArray(record.data(), static_cast<qsizetype>(record.size()))
+           << '\n';
   }
-
+  stream.flush();
   file.close();
 }
 
+void MainWindow::ParseData(std::string_view data) {
+  // the actual parsing is done column by column, split across all the cores
+  // for big dumps (see logParser.cpp), then the columns get spliced onto the
+  // end of the log. timestamps stay as msecs, nothing gets turned into a
+  // QDateTime here
+  const LogColumns columns = ParseLog(data);
+
+  // the device always sends its whole log, so after the first fetch most of
+  // it is already loaded. only the records newer than the last loaded one get
+  // added, which keeps the log in time order with nothing in it twice
+  std::size_t first_new = 0;
+  if (!log_columns_.empty()) {
+    const auto last_msecs = log_columns_.msecs.back();
+    first_new = static_cast<std::size_t>(
+        std::find_if(columns.msecs.begin(), columns.msecs.end(),
+                     [last_msecs](std::int64_t msecs) {
+                       return msecs > last_msecs;
+                     }) -
+        columns.msecs.begin());
+  }
+  log_columns_.Append(columns, first_new);
+
+  if (columns.rejected > 0) {
+    error_message_->showMessage(
+        tr(std::format("Skipped {} malformed log records", columns.rejected)
+               .c_str()));
+  }
+}
+
+void MainWindow::ClearLog() {
+  // drops the loaded log and everything worked out from it, so the next one
+  // starts from scratch
+  log_columns_.clear();
+  temp_analytics_.Reset();
+  analysed_records_ = 0;
+  rolling_mean_series_->clear();
+  rolling_min_series_->clear();
+  rolling_max_series_->clear();
+  excursion_series_->clear();
+}
+
 void MainWindow::BuildWebView() {
   // adds the coordinates from the logs to the map
   std::string markers_js;
-  foreach (auto &logdata, log_vector_) {
+  for (std::size_t i = 0; i < log_columns_.size(); i++) {
     markers_js += std::format(
         "new google.maps.Marker({{ position: {{lat: {}, lng: {}}}, map: map "
         "}});\n",
-        logdata.coordinates.latitude, logdata.coordinates.longitude);
+        log_columns_.latitude[i], log_columns_.longitude[i]);
     // adds a new line of javascript for each coordinate point in the log
   }
 
@@ -562,11 +1009,13 @@ void MainWindow::BuildChart() {
   temp_chart_->removeSeries(temp_series_.get());
 
   temp_series_ = std::make_unique<QLineSeries>();
-  foreach (auto datapoint, log_vector_) {
-    // NOLINTNEXTLINE
-    temp_series_->append(datapoint.datetime.toMSecsSinceEpoch(),
-                         datapoint.temperature);
+  QList<QPointF> points;
+  points.reserve(static_cast<qsizetype>(log_columns_.size()));
+  for (std::size_t i = 0; i < log_columns_.size(); i++) {
+    points.append(QPointF(static_cast<qreal>(log_columns_.msecs[i]),
+                          log_columns_.temperature[i]));
   }
+  temp_series_->append(points);
 
   temp_chart_->addSeries(temp_series_.get());
   temp_series_->attachAxis(axis_x_.get());
@@ -575,6 +1024,57 @@ void MainWindow::BuildChart() {
 
   temp_view_->update();
 }
+
+void MainWindow::UpdateAnalytics() {
+  // only the records merged in since the last call get fed through, and each
+  // of those is O(1), no matter how long the log has gotten. ParseData() only
+  // ever adds newer records, AddSample() turning away older ones is just a
+  // safety net
+  const std::size_t new_records = log_columns_.size() - analysed_records_;
+  QList<QPointF> mean_points;
+  QList<QPointF> min_points;
+  QList<QPointF> max_points;
+  mean_points.reserve(static_cast<qsizetype>(new_records));
+  min_points.reserve(static_cast<qsizetype>(new_records));
+  max_points.reserve(static_cast<qsizetype>(new_records));
+  for (; analysed_records_ < log_columns_.size(); analysed_records_++) {
+    const auto msecs = log_columns_.msecs[analysed_records_];
+    const double temperature = log_columns_.temperature[analysed_records_];
+    if (!temp_analytics_.AddSample(msecs, temperature)) continue;
+
+    const auto x = static_cast<qreal>(msecs);
+    mean_points.append(QPointF(x, temp_analytics_.RollingMean()));
+    min_points.append(QPointF(x, temp_analytics_.RollingMin()));
+    max_points.append(QPointF(x, temp_analytics_.RollingMax()));
+  }
+  // one append per series per fetch, every append redraws the chart
+  rolling_mean_series_->append(mean_points);
+  rolling_min_series_->append(min_points);
+  rolling_max_series_->append(max_points);
+
+  // one marker per excursion, at its peak. the last excursion might still be
+  // growing, so these get rebuilt, but there's only ever a handful of them
+  QList<QPointF> peaks;
+  peaks.reserve(static_cast<qsizetype>(temp_analytics_.Excursions().size()));
+  for (const auto &excursion : temp_analytics_.Excursions()) {
+    peaks.append(
+        QPointF(static_cast<qreal>(excursion.peak_msecs), excursion.peak));
+  }
+  excursion_series_->replace(peaks);
+
+  if (temp_analytics_.Count() == 0) {
+    temp_chart_->setTitle("Temperature");
+    return;
+  }
+  temp_chart_->setTitle(tr(
+      std::format("Temperature (min {:.1f}, max {:.1f}, mean {:.1f}, sd "
+                  "{:.1f}, {} excursions)",
+                  temp_analytics_.Min(), temp_analytics_.Max(),
+                  temp_analytics_.Mean(), temp_analytics_.StdDev(),
+                  temp_analytics_.Excursions().size())
+          .c_str()));
+}
+
 void MainWindow::UartConfig(QSerialPort *serial_port) {
   // configuring serial port, 9600-8-N-1
   serial_port->setParity(QSerialPort::NoParity);
@@ -584,14 +1084,102 @@ void MainWindow::UartConfig(QSerialPort *serial_port) {
   serial_port->setFlowControl(QSerialPort::SoftwareControl);
 }
 
+template <const auto &Command>
+bool MainWindow::RunCommand(const PayloadOf<Command> &payload,
+                            QByteArray *response) {
+  // every exchange with the device goes the same way: open the port, give the
+  // device a moment to wake up, send the command's frame, then read until the
+  // command's response policy says it's done. everything specific to one
+  // command lives in its table entry in deviceCommand.hpp
+  static_assert(Command.response_policy != ResponsePolicy::kStream,
+                "streamed commands are run by TelemetryStream");
+  if (!CheckValidPort()) return false;
+  // live view has the port open, and the device won't listen while streaming
+  if (telemetry_stream_->IsRunning()) StopLiveView();
+
+  QSerialPort serial_port;
+  serial_port.setPortName(tr(port_name_.c_str()));
+
+  UartConfig(&serial_port);
+
+  if (!serial_port.open(QIODevice::ReadWrite)) {
+    UartErrorHandler(serial_port.error());
+    return false;
+  }
+  std::this_thread::sleep_for(Command.settle_time);
+
+  if (!WriteCommand<Command>(&serial_port, payload)) {
+    error_message_->showMessage(tr("Device write error"));
+    return false;
+  }
+  if (!serial_port.waitForBytesWritten()) {
+    UartErrorHandler(serial_port.error());
+    return false;
+  }
+
+  // reads whatever arrives as soon as it arrives, rather than polling with
+  // sleeps, so acknowledgements return the moment they're complete
+  const QDeadlineTimer deadline(Command.total_timeout);
+  auto wait = Command.first_byte_timeout;
+  bool went_quiet = false;
+  while (!ResponseComplete<Command>(*response)) {
+    const auto remaining = std::chrono::milliseconds(deadline.remainingTime());
+    if (remaining <= std::chrono::milliseconds::zero()) break;
+
+    if (serial_port.waitForReadyRead(
+            static_cast<int>(std::min(wait, remaining).count()))) {
+      response->append(serial_port.readAll());
+      wait = Command.idle_timeout;
+      continue;
+    }
+    if (serial_port.error() != QSerialPort::TimeoutError) {
+      UartErrorHandler(serial_port.error());
+      return false;
+    }
+    // a drained command is finished once the device stops sending
+    if constexpr (Command.response_policy == ResponsePolicy::kDrain) {
+      went_quiet = true;
+      break;
+    }
+  }
+  response->append(serial_port.readAll());
+  serial_port.close();
+
+  if constexpr (Command.response_policy == ResponsePolicy::kDrain) {
+    // running into the deadline means the device was still sending, so
+    // whatever arrived is cut off part way through
+    if (!went_quiet) {
+      error_message_->showMessage(
+          tr("Device was still sending when the transfer timed out, the "
+             "received data is incomplete"));
+      return false;
+    }
+  }
+
+  if constexpr (Command.response_policy == ResponsePolicy::kAcknowledge) {
+    if (!ResponseComplete<Command>(*response)) {
+      error_message_->showMessage(tr("Device did not respond"));
+      return false;
+    }
+  }
+  return true;
+}
+
 bool MainWindow::CheckValidPort() {
   // checks to make sure the port being used is still a valid port
   // not strictly neccessary, opening the port would just fail if the port
-  // wasn't valid, but lets the user know why exactly things aren't working
-  bool good_port_name = false;
-  foreach (auto &port, QSerialPortInfo::availablePorts()) {
-    if (port.portName().toStdString() == port_name_) good_port_name = true;
+  // wasn't valid, but lets the user know why exactly things aren't working.
+  // without a working watch the registry never hears about ports coming and
+  // going, so it has to be asked to look again. its signals are held back
+  // while it does, PortArrivedHandler() switching ports in the middle of this
+  // would send the command to a device the user never picked
+  if (!port_registry_->IsWatching()) {
+    const QSignalBlocker blocker(port_registry_.get());
+    port_registry_->Refresh();
+    UpdatePortLabel();
   }
+  const bool good_port_name =
+      port_registry_->Contains(QString::fromStdString(port_name_));
   if (!good_port_name) {
     error_message_->showMessage(
         tr("Error: invalid or no port name specified. Please select a port "
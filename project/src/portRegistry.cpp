@@ -0,0 +1,69 @@
+#include "LeoGeo/portRegistry.hpp"
+
+#include <QFileSystemWatcher>
+#include <QHash>
+#include <QObject>
+#include <QSerialPortInfo>
+#include <QString>
+#include <QStringList>
+#include <QTimer>
+#include <memory>
+#include <utility>
+
+namespace {
+const QString kDevDir = "/dev";
+// plugging a device in creates several nodes in /dev in quick succession, so
+// changes are collected for a moment and enumerated just the once
+constexpr int kRescanDelayMsecs = 200;
+}  // namespace
+
+PortRegistry::PortRegistry(QObject *parent) : QObject(parent) {
+  rescan_timer_ = std::make_unique<QTimer>();
+  rescan_timer_->setSingleShot(true);
+  rescan_timer_->setInterval(kRescanDelayMsecs);
+  connect(rescan_timer_.get(), &QTimer::timeout, this, &PortRegistry::Refresh);
+
+  // QFileSystemWatcher uses inotify on linux (and kqueue on mac), so this
+  // costs nothing until /dev actually changes
+  watcher_ = std::make_unique<QFileSystemWatcher>();
+  watcher_->addPath(kDevDir);
+  connect(watcher_.get(), &QFileSystemWatcher::directoryChanged,
+          rescan_timer_.get(), qOverload<>(&QTimer::start));
+
+  Refresh();
+}
+
+bool PortRegistry::Contains(const QString &port_name) const {
+  return ports_.contains(port_name);
+}
+
+QStringList PortRegistry::PortNames() const {
+  QStringList names = ports_.keys();
+  names.sort();
+  return names;
+}
+
+QSerialPortInfo PortRegistry::Info(const QString &port_name) const {
+  return ports_.value(port_name);
+}
+
+bool PortRegistry::IsWatching() const {
+  return watcher_->directories().contains(kDevDir);
+}
+
+void PortRegistry::Refresh() {
+  // enumerates the ports, then compares against what we had before to work
+  // out what's arrived and what's gone
+  QHash<QString, QSerialPortInfo> ports;
+  foreach (auto &port, QSerialPortInfo::availablePorts()) {
+    ports.insert(port.portName(), port);
+  }
+  std::swap(ports, ports_);
+
+  for (auto it = ports.cbegin(); it != ports.cend(); ++it) {
+    if (!ports_.contains(it.key())) emit PortRemoved(it.key());
+  }
+  for (auto it = ports_.cbegin(); it != ports_.cend(); ++it) {
+    if (!ports.contains(it.key())) emit PortArrived(it.key());
+  }
+}
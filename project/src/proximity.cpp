@@ -0,0 +1,258 @@
+#include "LeoGeo/proximity.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <numbers>
+#include <thread>
+#include <vector>
+
+#include "LeoGeo/logParser.hpp"
+
+namespace {
+constexpr double kEarthRadiusMetres = 6371000.0;
+constexpr double kRadiansPerDegree = std::numbers::pi / 180.0;
+constexpr double kMetresPerDegree = kEarthRadiusMetres * kRadiansPerDegree;
+// a route with a few wild gps fixes in it could otherwise ask for a grid the
+// size of the planet, so past this the cells just get bigger instead
+constexpr std::int64_t kMaxCellsPerSide = 1024;
+// below this many targets it isn't worth starting threads
+constexpr std::size_t kMinTargetsPerThread = 64;
+
+double HaversineMetres(double lat_a, double lon_a, double lat_b,
+                       double lon_b) {
+  const double d_lat = (lat_b - lat_a) * kRadiansPerDegree;
+  const double d_lon = (lon_b - lon_a) * kRadiansPerDegree;
+  const double sin_lat = std::sin(d_lat / 2);
+  const double sin_lon = std::sin(d_lon / 2);
+  const double a = sin_lat * sin_lat + std::cos(lat_a * kRadiansPerDegree) *
+                                           std::cos(lat_b * kRadiansPerDegree) *
+                                           sin_lon * sin_lon;
+  return 2 * kEarthRadiusMetres * std::asin(std::min(1.0, std::sqrt(a)));
+}
+
+// the hot loop. plain arrays in, plain array out and no branches, so the
+// compiler turns it into simd instructions on its own
+void SquaredDistances(const double *xs, const double *ys, std::size_t count,
+                      double x, double y, double *out) {
+  for (std::size_t i = 0; i < count; i++) {
+    const double dx = xs[i] - x;  // NOLINT
+    const double dy = ys[i] - y;  // NOLINT
+    out[i] = dx * dx + dy * dy;   // NOLINT
+  }
+}
+}  // namespace
+
+ProximityEngine::ProximityEngine(const LogColumns &log, double cell_metres)
+    : log_(log), cell_metres_(cell_metres) {
+  if (log_.empty()) return;
+
+  // projects everything onto a flat plane centred on the route's average
+  // position. over the few kilometres an event covers that's off by well
+  // under a metre, and it turns every distance into a couple of multiplies.
+  // the average rather than the middle of the bounding box, so one wild gps
+  // fix can't drag the centre (and the scale) away from the actual route
+  const std::size_t count = log_.size();
+  for (std::size_t i = 0; i < count; i++) {
+    ref_latitude_ += log_.latitude[i];
+    ref_longitude_ += log_.longitude[i];
+  }
+  ref_latitude_ /= static_cast<double>(count);
+  ref_longitude_ /= static_cast<double>(count);
+  metres_per_degree_lon_ =
+      kMetresPerDegree * std::cos(ref_latitude_ * kRadiansPerDegree);
+
+  std::vector<double> xs(count);
+  std::vector<double> ys(count);
+  for (std::size_t i = 0; i < count; i++) {
+    xs[i] = (log_.longitude[i] - ref_longitude_) * metres_per_degree_lon_;
+    ys[i] = (log_.latitude[i] - ref_latitude_) * kMetresPerDegree;
+  }
+
+  const auto [min_x, max_x] = std::minmax_element(xs.begin(), xs.end());
+  const auto [min_y, max_y] = std::minmax_element(ys.begin(), ys.end());
+  min_x_ = *min_x;
+  min_y_ = *min_y;
+  const double extent = std::max(*max_x - min_x_, *max_y - min_y_);
+  cell_metres_ = std::max(cell_metres_, extent / kMaxCellsPerSide);
+  cells_x_ = CellX(*max_x) + 1;
+  cells_y_ = CellY(*max_y) + 1;
+
+  // counting sort of the points by cell: count each cell, turn the counts
+  // into start offsets, then drop every point into its slot
+  const auto cell_count = static_cast<std::size_t>(cells_x_ * cells_y_);
+  std::vector<std::size_t> point_cell(count);
+  cell_start_.assign(cell_count + 1, 0);
+  for (std::size_t i = 0; i < count; i++) {
+    point_cell[i] =
+        static_cast<std::size_t>(CellY(ys[i]) * cells_x_ + CellX(xs[i]));
+    cell_start_[point_cell[i] + 1]++;
+  }
+  for (std::size_t cell = 0; cell < cell_count; cell++) {
+    max_cell_size_ = std::max(max_cell_size_, cell_start_[cell + 1]);
+    cell_start_[cell + 1] += cell_start_[cell];
+  }
+
+  xs_.resize(count);
+  ys_.resize(count);
+  indices_.resize(count);
+  std::vector<std::size_t> next(cell_start_.begin(), cell_start_.end() - 1);
+  // going through the points in log order keeps each cell's points in time
+  // order too
+  for (std::size_t i = 0; i < count; i++) {
+    const std::size_t slot = next[point_cell[i]]++;
+    xs_[slot] = xs[i];
+    ys_[slot] = ys[i];
+    indices_[slot] = i;
+  }
+}
+
+std::vector<TargetReport> ProximityEngine::Evaluate(
+    const std::vector<GeoTarget> &targets) const {
+  std::vector<TargetReport> reports(targets.size());
+  if (log_.empty()) return reports;
+
+  // every target is independent of the others, so big batches get split
+  // across the cores, each thread writing only its own slice of reports
+  const std::size_t threads = std::max<std::size_t>(
+      1, std::min<std::size_t>(std::thread::hardware_concurrency(),
+                               targets.size() / kMinTargetsPerThread));
+  const auto evaluate_range = [this, &targets, &reports](std::size_t begin,
+                                                         std::size_t end) {
+    std::vector<double> scratch(max_cell_size_);
+    for (std::size_t i = begin; i < end; i++) {
+      reports[i] = EvaluateOne(targets[i], &scratch);
+    }
+  };
+
+  if (threads == 1) {
+    evaluate_range(0, targets.size());
+    return reports;
+  }
+  std::vector<std::jthread> workers;
+  workers.reserve(threads);
+  for (std::size_t t = 0; t < threads; t++) {
+    workers.emplace_back(evaluate_range, targets.size() * t / threads,
+                         targets.size() * (t + 1) / threads);
+  }
+  workers.clear();  // joins
+  return reports;
+}
+
+ProximityEngine::Projected ProximityEngine::Project(double latitude,
+                                                    double longitude) const {
+  return Projected{(longitude - ref_longitude_) * metres_per_degree_lon_,
+                   (latitude - ref_latitude_) * kMetresPerDegree};
+}
+
+std::int64_t ProximityEngine::CellX(double x) const {
+  return static_cast<std::int64_t>(std::floor((x - min_x_) / cell_metres_));
+}
+
+std::int64_t ProximityEngine::CellY(double y) const {
+  return static_cast<std::int64_t>(std::floor((y - min_y_) / cell_metres_));
+}
+
+void ProximityEngine::CellDistances(std::size_t cell, double x, double y,
+                                    std::vector<double> *scratch) const {
+  const std::size_t begin = cell_start_[cell];
+  SquaredDistances(&xs_[begin], &ys_[begin], cell_start_[cell + 1] - begin, x,
+                   y, scratch->data());
+}
+
+TargetReport ProximityEngine::EvaluateOne(const GeoTarget &target,
+                                          std::vector<double> *scratch) const {
+  TargetReport report;
+  report.has_points = true;
+  const auto [x, y] = Project(target.latitude, target.longitude);
+  const std::int64_t target_cx = CellX(x);
+  const std::int64_t target_cy = CellY(y);
+
+  // closest approach: search outwards from the target's cell one ring of
+  // cells at a time. every point in ring k is at least (k - 1) cells away, so
+  // once that's further than the best so far, nothing further out can win.
+  // the target might be off the grid entirely, so start at the first ring
+  // that actually touches it
+  const std::int64_t first_ring = std::max<std::int64_t>(
+      {0, -target_cx, target_cx - (cells_x_ - 1), -target_cy,
+       target_cy - (cells_y_ - 1)});
+  const std::int64_t last_ring = std::max<std::int64_t>(
+      {target_cx, cells_x_ - 1 - target_cx, target_cy,
+       cells_y_ - 1 - target_cy});
+
+  double best = std::numeric_limits<double>::max();
+  std::size_t best_slot = 0;
+  const auto search_cell = [&](std::int64_t cx, std::int64_t cy) {
+    if (cx < 0 || cx >= cells_x_ || cy < 0 || cy >= cells_y_) return;
+    const auto cell = static_cast<std::size_t>(cy * cells_x_ + cx);
+    const std::size_t begin = cell_start_[cell];
+    const std::size_t size = cell_start_[cell + 1] - begin;
+    if (size == 0) return;
+    CellDistances(cell, x, y, scratch);
+    const auto closest = std::min_element(scratch->begin(),
+                                          scratch->begin() +
+                                              static_cast<std::ptrdiff_t>(size));
+    if (*closest < best) {
+      best = *closest;
+      best_slot = begin + static_cast<std::size_t>(closest - scratch->begin());
+    }
+  };
+  for (std::int64_t ring = first_ring; ring <= last_ring; ring++) {
+    const double reach = static_cast<double>(ring - 1) * cell_metres_;
+    if (ring > 0 && reach > 0 && reach * reach > best) break;
+    for (std::int64_t cy = target_cy - ring; cy <= target_cy + ring; cy++) {
+      if (cy < 0 || cy >= cells_y_) continue;
+      if (cy == target_cy - ring || cy == target_cy + ring) {
+        for (std::int64_t cx = target_cx - ring; cx <= target_cx + ring; cx++) {
+          search_cell(cx, cy);
+        }
+      } else {
+        search_cell(target_cx - ring, cy);
+        if (ring > 0) search_cell(target_cx + ring, cy);
+      }
+    }
+  }
+  const std::size_t closest_index = indices_[best_slot];
+  report.closest_m =
+      HaversineMetres(target.latitude, target.longitude,
+                      log_.latitude[closest_index],
+                      log_.longitude[closest_index]);
+  report.closest_msecs = log_.msecs[closest_index];
+
+  // arrival and dwell: only the cells the radius overlaps can hold points
+  // inside it
+  const double radius_squared = target.radius_m * target.radius_m;
+  std::vector<std::size_t> hits;
+  const std::int64_t from_cx = std::max<std::int64_t>(0, CellX(x - target.radius_m));
+  const std::int64_t to_cx = std::min(cells_x_ - 1, CellX(x + target.radius_m));
+  const std::int64_t from_cy = std::max<std::int64_t>(0, CellY(y - target.radius_m));
+  const std::int64_t to_cy = std::min(cells_y_ - 1, CellY(y + target.radius_m));
+  for (std::int64_t cy = from_cy; cy <= to_cy; cy++) {
+    for (std::int64_t cx = from_cx; cx <= to_cx; cx++) {
+      const auto cell = static_cast<std::size_t>(cy * cells_x_ + cx);
+      const std::size_t begin = cell_start_[cell];
+      const std::size_t size = cell_start_[cell + 1] - begin;
+      if (size == 0) continue;
+      CellDistances(cell, x, y, scratch);
+      for (std::size_t i = 0; i < size; i++) {
+        if ((*scratch)[i] <= radius_squared) hits.push_back(indices_[begin + i]);
+      }
+    }
+  }
+  if (hits.empty()) return report;
+
+  // back in log (so time) order, time between two consecutive records that
+  // are both inside the radius counts as dwelling there. only time going
+  // forwards counts, so a log that isn't in order can't take dwell away
+  std::sort(hits.begin(), hits.end());
+  report.reached = true;
+  report.first_arrival_msecs = log_.msecs[hits.front()];
+  for (std::size_t i = 1; i < hits.size(); i++) {
+    if (hits[i] != hits[i - 1] + 1) continue;
+    const std::int64_t step = log_.msecs[hits[i]] - log_.msecs[hits[i - 1]];
+    if (step > 0) report.dwell_msecs += step;
+  }
+  return report;
+}
@@ -0,0 +1,135 @@
+#include "LeoGeo/telemetryStream.hpp"
+
+#include <QDeadlineTimer>
+#include <QSerialPort>
+#include <QString>
+#include <QThread>
+#include <array>
+#include <cctype>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <thread>
+
+#include "LeoGeo/deviceCommand.hpp"
+#include "LeoGeo/logParser.hpp"
+
+namespace {
+// how often the reader checks whether it's been asked to stop
+constexpr int kPollMsecs = 50;
+// a single record is well under 100 bytes, anything longer without a ';' is
+// line noise
+constexpr std::size_t kMaxPendingBytes = 4096;
+}  // namespace
+
+TelemetryStream::~TelemetryStream() { Stop(); }
+
+void TelemetryStream::Start(const QString &port_name,
+                            void (*configure)(QSerialPort *)) {
+  Stop();
+  // the reader is gone, so it's safe to throw away whatever it left behind
+  ring_.Drain([](const TelemetrySample &) {});
+  error_.store(QSerialPort::NoError, std::memory_order_release);
+  dropped_.store(0, std::memory_order_relaxed);
+
+  reader_.reset(QThread::create(
+      [this, port_name, configure] { Run(port_name, configure); }));
+  reader_->start();
+}
+
+void TelemetryStream::Stop() {
+  if (!reader_) return;
+  reader_->requestInterruption();
+  reader_->wait();
+  reader_.reset();
+}
+
+void TelemetryStream::Run(const QString &port_name,
+                          void (*configure)(QSerialPort *)) {
+  // the serial port has to live on the thread that reads from it, so it's
+  // opened here rather than by the ui
+  QSerialPort serial_port;
+  serial_port.setPortName(port_name);
+  configure(&serial_port);
+
+  const auto fail = [this, &serial_port] {
+    const auto error = serial_port.error();
+    error_.store(error == QSerialPort::NoError ? QSerialPort::TimeoutError
+                                               : error,
+                 std::memory_order_release);
+  };
+
+  if (!serial_port.open(QIODevice::ReadWrite)) {
+    fail();
+    return;
+  }
+  std::this_thread::sleep_for(device_commands::kStreamStart.settle_time);
+  if (!WriteCommand<device_commands::kStreamStart>(&serial_port) ||
+      !serial_port.waitForBytesWritten()) {
+    fail();
+    return;
+  }
+
+  // everything here is allocated once up front, so a long session at a high
+  // sample rate doesn't keep growing anything
+  std::array<char, kMaxPendingBytes> buffer{};
+  std::string pending;
+  pending.reserve(2 * kMaxPendingBytes);
+  LogColumns record;
+  record.reserve(1);
+
+  QDeadlineTimer silence(device_commands::kStreamStart.first_byte_timeout);
+  QThread *const thread = QThread::currentThread();
+  while (!thread->isInterruptionRequested()) {
+    if (!serial_port.waitForReadyRead(kPollMsecs)) {
+      if (serial_port.error() != QSerialPort::TimeoutError) {
+        fail();
+        return;
+      }
+      if (silence.hasExpired()) {
+        error_.store(QSerialPort::TimeoutError, std::memory_order_release);
+        return;
+      }
+      continue;
+    }
+    silence.setRemainingTime(device_commands::kStreamStart.idle_timeout);
+
+    const auto read = serial_port.read(buffer.data(),
+                                       static_cast<qint64>(buffer.size()));
+    if (read < 0) {
+      fail();
+      return;
+    }
+    pending.append(buffer.data(), static_cast<std::size_t>(read));
+
+    // hand over every complete record, keeping any partial one for next time
+    std::size_t start = 0;
+    for (auto end = pending.find(';'); end != std::string::npos;
+         end = pending.find(';', start)) {
+      record.clear();
+      std::string_view text(pending.data() + start, end - start);
+      start = end + 1;
+      while (!text.empty() &&
+             std::isspace(static_cast<unsigned char>(text.front()))) {
+        text.remove_prefix(1);
+      }
+      if (!ParseLogRecord(text, &record)) continue;
+
+      const TelemetrySample sample{record.msecs.front(),
+                                   record.latitude.front(),
+                                   record.longitude.front(),
+                                   record.temperature.front()};
+      if (!ring_.TryPush(sample)) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+      }
+    }
+    pending.erase(0, start);
+    if (pending.size() > kMaxPendingBytes) pending.clear();
+  }
+
+  // tell the device to stop streaming before letting go of the port
+  WriteCommand<device_commands::kStreamStop>(&serial_port);
+  serial_port.waitForBytesWritten(
+      static_cast<int>(device_commands::kStreamStop.total_timeout.count()));
+  serial_port.close();
+}
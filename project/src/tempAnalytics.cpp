@@ -0,0 +1,124 @@
+#include "LeoGeo/tempAnalytics.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+TempAnalytics::TempAnalytics(std::int64_t window_msecs, double low_limit,
+                             double high_limit)
+    : window_msecs_(window_msecs),
+      low_limit_(low_limit),
+      high_limit_(high_limit) {}
+
+bool TempAnalytics::AddSample(std::int64_t msecs, double temperature) {
+  // everything in here is O(1) (amortised for the deques), so this can be
+  // called for every record as it comes in without ever going back over the
+  // older data. the window and the monotonic queues only work if time never
+  // goes backwards, so older samples are turned away here
+  if (count_ > 0 && msecs <= last_msecs_) return false;
+  last_msecs_ = msecs;
+
+  count_++;
+  if (count_ == 1) {
+    min_ = temperature;
+    max_ = temperature;
+  } else {
+    min_ = std::min(min_, temperature);
+    max_ = std::max(max_, temperature);
+  }
+  const double delta = temperature - mean_;
+  mean_ += delta / static_cast<double>(count_);
+  m2_ += delta * (temperature - mean_);
+
+  window_.push_back(Sample{msecs, temperature});
+  window_sum_ += temperature;
+  // anything that can never be the window's min (or max) again gets dropped
+  // off the back before the new sample goes in
+  while (!window_min_.empty() && window_min_.back().temperature >= temperature)
+    window_min_.pop_back();
+  window_min_.push_back(Sample{msecs, temperature});
+  while (!window_max_.empty() && window_max_.back().temperature <= temperature)
+    window_max_.pop_back();
+  window_max_.push_back(Sample{msecs, temperature});
+  EvictOld(msecs);
+
+  TrackExcursion(msecs, temperature);
+  return true;
+}
+
+void TempAnalytics::Reset() {
+  count_ = 0;
+  last_msecs_ = 0;
+  mean_ = 0.0;
+  m2_ = 0.0;
+  min_ = 0.0;
+  max_ = 0.0;
+  window_.clear();
+  window_min_.clear();
+  window_max_.clear();
+  window_sum_ = 0.0;
+  in_excursion_ = false;
+  excursions_.clear();
+}
+
+double TempAnalytics::Variance() const {
+  if (count_ < 2) return 0.0;
+  return m2_ / static_cast<double>(count_ - 1);
+}
+
+double TempAnalytics::StdDev() const { return std::sqrt(Variance()); }
+
+double TempAnalytics::RollingMean() const {
+  if (window_.empty()) return 0.0;
+  return window_sum_ / static_cast<double>(window_.size());
+}
+
+double TempAnalytics::RollingMin() const {
+  if (window_min_.empty()) return 0.0;
+  return window_min_.front().temperature;
+}
+
+double TempAnalytics::RollingMax() const {
+  if (window_max_.empty()) return 0.0;
+  return window_max_.front().temperature;
+}
+
+void TempAnalytics::EvictOld(std::int64_t newest_msecs) {
+  const std::int64_t cutoff = newest_msecs - window_msecs_;
+  while (!window_.empty() && window_.front().msecs < cutoff) {
+    window_sum_ -= window_.front().temperature;
+    window_.pop_front();
+  }
+  while (!window_min_.empty() && window_min_.front().msecs < cutoff)
+    window_min_.pop_front();
+  while (!window_max_.empty() && window_max_.front().msecs < cutoff)
+    window_max_.pop_front();
+}
+
+void TempAnalytics::TrackExcursion(std::int64_t msecs, double temperature) {
+  const bool above = temperature > high_limit_;
+  const bool below = temperature < low_limit_;
+
+  if (!above && !below) {
+    in_excursion_ = false;
+    return;
+  }
+
+  // a reading on the other side of the range from the open excursion starts a
+  // new one, otherwise it just extends the current one
+  if (in_excursion_ && excursions_.back().above == above) {
+    TempExcursion &current = excursions_.back();
+    current.end_msecs = msecs;
+    if (above ? temperature > current.peak : temperature < current.peak) {
+      current.peak = temperature;
+      current.peak_msecs = msecs;
+    }
+    return;
+  }
+
+  excursions_.push_back(
+      TempExcursion{msecs, msecs, temperature, msecs, above});
+  in_excursion_ = true;
+}